@@ -152,5 +152,209 @@ namespace Sapphire
                     m.combFilter.interpKind = interpKind;
             }
         };
+
+
+        template <unsigned MAX_FILTER_STAGES, unsigned MAX_CHANNELS>
+        class CascadeFilterBank
+        {
+            // The same filters as CascadeFilter, for up to MAX_CHANNELS channels.
+            // Channels are processed 4 at a time in SIMD lanes, with one set of filter state
+            // per group of 4 channels instead of per channel.
+            // With FilterTanMode::Exact, every channel produces exactly the same output as its own CascadeFilter.
+
+        public:
+            static constexpr unsigned maxQuads = (MAX_CHANNELS + 3) / 4;
+
+        private:
+            using scalar_filter_t = Gravy::SingleChannelGravyEngine<float>;
+            using vector_t = PhysicsVector;
+
+            struct MultiFilter
+            {
+                QuadStateVariableFilter bandpassFilter;
+                QuadStateVariableFilter notchFilter;
+                QuadCombFilter          combFilter;
+
+                void initialize()
+                {
+                    bandpassFilter.initialize();
+                    notchFilter.initialize();
+                    combFilter.initialize();
+                    combFilter.centerFrequencyHz = C4_FREQUENCY_HZ;
+                }
+            };
+
+            struct Quad
+            {
+                std::array<MultiFilter, MAX_FILTER_STAGES> multi;
+
+                // Knob values for the bandpass and notch filters, as SingleChannelGravyEngine keeps them.
+                vector_t freqKnob = Gravy::DefaultFrequencyKnob;
+                vector_t bandResKnob = Gravy::DefaultResonanceKnob;
+                vector_t notchResKnob = Gravy::DefaultResonanceKnob;
+                vector_t resonanceKnob{};
+
+                void initialize()
+                {
+                    for (MultiFilter& m : multi)
+                        m.initialize();
+                }
+            };
+
+            static_assert(MAX_FILTER_STAGES > 0);
+            static_assert(MAX_CHANNELS > 0);
+            std::array<Quad, maxQuads> quad;
+
+            static void setKnob(float& v, float k)
+            {
+                // Same as SingleChannelGravyEngine::setKnob.
+                if (std::isfinite(k))
+                    v = ClampInt(k, 0, 1);
+            }
+
+        public:
+            void initialize()
+            {
+                for (Quad& q : quad)
+                    q.initialize();
+            }
+
+            void setFrequency(int channel, float knob)
+            {
+                Quad& q = quad.at(channel / 4);
+                const int lane = channel % 4;
+                if (std::isfinite(knob))
+                    q.freqKnob[lane] = ClampInt(knob, -Gravy::OctaveRange, +Gravy::OctaveRange);
+                for (MultiFilter& m : q.multi)
+                    m.combFilter.setFrequency(lane, knob);
+            }
+
+            void setResonance(int channel, float knob)
+            {
+                constexpr float bandScale = 0.75;
+                constexpr float notchScale = 0.25;
+                constexpr float combScale = 0.6;
+
+                Quad& q = quad.at(channel / 4);
+                const int lane = channel % 4;
+                const float res = std::clamp<float>(knob, 0, 1);
+                q.resonanceKnob[lane] = res;
+                setKnob(q.bandResKnob[lane], bandScale * res);
+                setKnob(q.notchResKnob[lane], notchScale * res);
+                for (MultiFilter& m : q.multi)
+                    m.combFilter.setResonance(lane, combScale * res);
+            }
+
+            void setInterpolator(InterpolatorKind interpKind)
+            {
+                for (Quad& q : quad)
+                    for (MultiFilter& m : q.multi)
+                        m.combFilter.interpKind = interpKind;
+            }
+
+            void setTanMode(FilterTanMode tanMode)
+            {
+                for (Quad& q : quad)
+                {
+                    for (MultiFilter& m : q.multi)
+                    {
+                        m.bandpassFilter.setTanMode(tanMode);
+                        m.notchFilter.setTanMode(tanMode);
+                    }
+                }
+            }
+
+            void process(
+                float sampleRateHz,
+                int nchannels,
+                const float* inSample,
+                const float* cascade,
+                float modeMix,
+                float* outSample)
+            {
+                nchannels = std::clamp<int>(nchannels, 0, MAX_CHANNELS);
+
+                // Gain and mix are always at their defaults in the cascade, just like CascadeFilter.
+                const float gain = Cube(Gravy::DefaultGainKnob * 2);
+                const float mix = scalar_filter_t::MixFactor(Gravy::DefaultMixKnob);
+                const float centerFrequencyHz = C4_FREQUENCY_HZ;
+                const bool needBandpass = (modeMix != 1);
+                const bool needNotch = (modeMix != 0);
+
+                for (int c = 0; c < nchannels; c += 4)
+                {
+                    Quad& q = quad[c / 4];
+                    const int nlanes = std::min(4, nchannels - c);
+
+                    vector_t dry;
+                    for (int i = 0; i < nlanes; ++i)
+                        dry[i] = inSample[c + i];
+
+                    // All stages share the same corner frequency.
+                    vector_t cornerFreqHz;
+                    for (int i = 0; i < 4; ++i)
+                        cornerFreqHz[i] = TwoToPower(q.freqKnob[i]) * centerFrequencyHz;
+
+                    struct iter_t
+                    {
+                        vector_t bandpass;
+                        vector_t notch;
+                        vector_t comb;
+                    };
+
+                    std::array<iter_t, 1+MAX_FILTER_STAGES> iter;
+                    iter[0].bandpass = iter[0].notch = iter[0].comb = dry;
+
+                    // Skip the filters that CascadeFilter skips, so the filter state stays identical.
+                    for (unsigned s = 0; s < MAX_FILTER_STAGES; ++s)
+                    {
+                        MultiFilter& m = q.multi[s];
+                        if (needBandpass)
+                        {
+                            const vector_t& x = iter[s].bandpass;
+                            FilterResult<vector_t> r = m.bandpassFilter.process(sampleRateHz, cornerFreqHz, q.bandResKnob, x);
+                            iter[s+1].bandpass = gain * (mix*r.bandpass + (1-mix)*x);
+                        }
+                        if (needNotch)
+                        {
+                            const vector_t& x = iter[s].notch;
+                            FilterResult<vector_t> r = m.notchFilter.process(sampleRateHz, cornerFreqHz, q.notchResKnob, x);
+                            const vector_t lowpass  = gain * (mix*r.lowpass  + (1-mix)*x);
+                            const vector_t highpass = gain * (mix*r.highpass + (1-mix)*x);
+                            iter[s+1].notch = lowpass + highpass;
+                            iter[s+1].comb = m.combFilter.process(sampleRateHz, iter[s].comb);
+                        }
+                    }
+
+                    // Each channel blends the outputs of the stages selected by its own cascade value.
+                    for (int i = 0; i < nlanes; ++i)
+                    {
+                        const float cascadeClamp = std::clamp<float>(cascade[c + i], 0, MAX_FILTER_STAGES);
+                        unsigned k = static_cast<unsigned>(std::floor(cascadeClamp));
+                        float fraction = cascadeClamp - k;
+                        if (k >= MAX_FILTER_STAGES)
+                        {
+                            k = MAX_FILTER_STAGES - 1;
+                            fraction = 1;
+                        }
+
+                        const iter_t& ik0 = iter[k+0];
+                        const iter_t& ik1 = iter[k+1];
+                        const float yb = LinearMix(fraction, ik0.bandpass[i], ik1.bandpass[i]);
+                        if (modeMix == 0)
+                        {
+                            outSample[c + i] = yb;
+                        }
+                        else
+                        {
+                            const float yn = LinearMix(fraction, ik0.notch[i], ik1.notch[i]);
+                            const float yc = LinearMix(fraction, ik0.comb[i], ik1.comb[i]);
+                            const float ync = LinearMix(q.resonanceKnob[i], yn, yc);
+                            outSample[c + i] = (modeMix == 1) ? ync : LinearMix(modeMix, yb, ync);
+                        }
+                    }
+                }
+            }
+        };
     }
 }
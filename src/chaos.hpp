@@ -70,6 +70,13 @@ namespace Sapphire
     }
 
 
+    enum class ChaosIntegrator
+    {
+        RungeKutta4,        // fixed step size, oversampled to stay within max_dt
+        DormandPrince,      // adaptive step size with error control, interpolated to each sample
+    };
+
+
     struct ChaoticOscillatorState
     {
         // The internal state of a chaotic oscillator, provided for memory store/recall.
@@ -133,6 +140,157 @@ namespace Sapphire
         double y1{};
         double z1{};
 
+        // Adaptive Dormand-Prince integrator state.
+        // The integrator runs ahead of the output by up to one step.
+        // Each step starts at `ys` and ends at `ye`, taking simulated time `hs`.
+        // `tau` is how far the output is into the current step.
+        // The stage slopes `k` are folded into the interpolating polynomial `q`.
+        ChaosIntegrator integrator = ChaosIntegrator::RungeKutta4;
+        double tolerance = 1.0e-6;
+        bool denseValid = false;
+        double hs = 0;
+        double hNext = 0;
+        double tau = 0;
+        double ys[3]{};
+        double ye[3]{};
+        double k[7][3]{};
+        double q[3][4]{};
+
+        static constexpr int MaxStepSamples = 32;   // keeps parameter changes taking effect at least every 32 samples
+        static constexpr double MaxStepRatio = 4.0;  // largest step allowed, as a multiple of max_dt
+        static constexpr int MaxRejects = 20;
+
+        void slopeArray(double out[3], const double y[3]) const
+        {
+            SlopeVector v = vel(y[0], y[1], y[2]);
+            out[0] = v.mx;
+            out[1] = v.my;
+            out[2] = v.mz;
+        }
+
+        double attemptStep(double h, double yn[3])
+        {
+            // Dormand-Prince 5(4) stages. Returns the error norm, where <= 1 is acceptable.
+            static constexpr double a21 = 1.0/5;
+            static constexpr double a31 = 3.0/40, a32 = 9.0/40;
+            static constexpr double a41 = 44.0/45, a42 = -56.0/15, a43 = 32.0/9;
+            static constexpr double a51 = 19372.0/6561, a52 = -25360.0/2187, a53 = 64448.0/6561, a54 = -212.0/729;
+            static constexpr double a61 = 9017.0/3168, a62 = -355.0/33, a63 = 46732.0/5247, a64 = 49.0/176, a65 = -5103.0/18656;
+            static constexpr double b1 = 35.0/384, b3 = 500.0/1113, b4 = 125.0/192, b5 = -2187.0/6784, b6 = 11.0/84;
+            static constexpr double e1 = 71.0/57600, e3 = -71.0/16695, e4 = 71.0/1920, e5 = -17253.0/339200, e6 = 22.0/525, e7 = -1.0/40;
+
+            double y[3];
+            slopeArray(k[0], ys);
+            for (int i = 0; i < 3; ++i) y[i] = ys[i] + h*(a21*k[0][i]);
+            slopeArray(k[1], y);
+            for (int i = 0; i < 3; ++i) y[i] = ys[i] + h*(a31*k[0][i] + a32*k[1][i]);
+            slopeArray(k[2], y);
+            for (int i = 0; i < 3; ++i) y[i] = ys[i] + h*(a41*k[0][i] + a42*k[1][i] + a43*k[2][i]);
+            slopeArray(k[3], y);
+            for (int i = 0; i < 3; ++i) y[i] = ys[i] + h*(a51*k[0][i] + a52*k[1][i] + a53*k[2][i] + a54*k[3][i]);
+            slopeArray(k[4], y);
+            for (int i = 0; i < 3; ++i) y[i] = ys[i] + h*(a61*k[0][i] + a62*k[1][i] + a63*k[2][i] + a64*k[3][i] + a65*k[4][i]);
+            slopeArray(k[5], y);
+            for (int i = 0; i < 3; ++i) yn[i] = ys[i] + h*(b1*k[0][i] + b3*k[2][i] + b4*k[3][i] + b5*k[4][i] + b6*k[5][i]);
+            slopeArray(k[6], yn);
+
+            // Scale the error by the size of each variable's attractor range.
+            const double range[3] = { std::abs(xmax - xmin), std::abs(ymax - ymin), std::abs(zmax - zmin) };
+            double norm = 0;
+            for (int i = 0; i < 3; ++i)
+            {
+                double err = h*(e1*k[0][i] + e3*k[2][i] + e4*k[3][i] + e5*k[4][i] + e6*k[5][i] + e7*k[6][i]);
+                double scale = tolerance * std::max(1.0, range[i]);
+                norm = std::max(norm, std::abs(err) / scale);
+            }
+            return norm;
+        }
+
+        void prepareDenseOutput()
+        {
+            // 4th order continuous extension of Dormand-Prince, as used by DOPRI5.
+            // Fold the stage slopes into polynomial coefficients once per step,
+            // so each output sample only needs to evaluate a quartic.
+            static constexpr double P[7][4] =
+            {
+                { 1.0, -8048581381.0/2820520608.0, 8663915743.0/2820520608.0, -12715105075.0/11282082432.0 },
+                { 0.0, 0.0, 0.0, 0.0 },
+                { 0.0, 131558114200.0/32700410799.0, -68118460800.0/10900136933.0, 87487479700.0/32700410799.0 },
+                { 0.0, -1754552775.0/470086768.0, 14199869525.0/1410260304.0, -10690763975.0/1880347072.0 },
+                { 0.0, 127303824393.0/49829197408.0, -318862633887.0/49829197408.0, 701980252875.0/199316789632.0 },
+                { 0.0, -282668133.0/205662961.0, 2019193451.0/616988883.0, -1453857185.0/822651844.0 },
+                { 0.0, 40617522.0/29380423.0, -110615467.0/29380423.0, 69997945.0/29380423.0 },
+            };
+
+            for (int i = 0; i < 3; ++i)
+            {
+                for (int c = 0; c < 4; ++c)
+                {
+                    double sum = 0;
+                    for (int s = 0; s < 7; ++s)
+                        sum += P[s][c] * k[s][i];
+                    q[i][c] = hs * sum;
+                }
+            }
+        }
+
+        double denseOutput(int i, double theta) const
+        {
+            return ys[i] + theta*(q[i][0] + theta*(q[i][1] + theta*(q[i][2] + theta*q[i][3])));
+        }
+
+        void adaptiveUpdate(double dt)
+        {
+            // Let the error estimate choose the step size, but stay within a few multiples
+            // of the RK4 limit `max_dt` so a stiff region cannot launch a wild first attempt.
+            double hmax = MaxStepSamples * dt;
+            if (max_dt > 0.0)
+                hmax = std::min(hmax, MaxStepRatio * max_dt);
+
+            if (!denseValid)
+            {
+                ys[0] = ye[0] = x1;
+                ys[1] = ye[1] = y1;
+                ys[2] = ye[2] = z1;
+                hs = 0;
+                tau = 0;
+                if (!(hNext > 0.0))
+                    hNext = hmax;
+                denseValid = true;
+            }
+
+            tau += dt;
+            while (tau > hs)
+            {
+                // The output has moved past the end of the current step. Take another step.
+                tau -= hs;
+                ys[0] = ye[0];
+                ys[1] = ye[1];
+                ys[2] = ye[2];
+
+                double h = std::min(hNext, hmax);
+                for (int attempt = 0; ; ++attempt)
+                {
+                    double error = attemptStep(h, ye);
+                    if (error <= 1.0 || attempt == MaxRejects || !std::isfinite(error))
+                    {
+                        // Accept the step. Choose the next step size using the usual 1/5 power rule.
+                        hs = h;
+                        prepareDenseOutput();
+                        double factor = (error > 0.0) ? 0.9 * std::pow(error, -0.2) : 5.0;
+                        hNext = h * std::clamp(factor, 0.2, 5.0);
+                        break;
+                    }
+                    h *= std::max(0.2, 0.9 * std::pow(error, -0.2));
+                }
+            }
+
+            const double theta = tau / hs;
+            x1 = denseOutput(0, theta);
+            y1 = denseOutput(1, theta);
+            z1 = denseOutput(2, theta);
+        }
+
     public:
         virtual ~ChaoticOscillator() {}
 
@@ -175,6 +333,9 @@ namespace Sapphire
             speedFactor = 1;
             dilate = 1;
             xTranslate = yTranslate = zTranslate = 0;
+            integrator = ChaosIntegrator::RungeKutta4;
+            denseValid = false;
+            hNext = 0;
         }
 
         void setKnob(double k)
@@ -283,10 +444,46 @@ namespace Sapphire
 
         virtual void updateParameters() {}
 
+        ChaosIntegrator getIntegrator() const
+        {
+            return integrator;
+        }
+
+        void setIntegrator(ChaosIntegrator _integrator)
+        {
+            if (integrator != _integrator)
+            {
+                integrator = _integrator;
+                denseValid = false;
+            }
+        }
+
+        double getTolerance() const
+        {
+            return tolerance;
+        }
+
+        void setTolerance(double _tolerance)
+        {
+            // Maximum local error per step for the Dormand-Prince integrator,
+            // relative to the size of the attractor.
+            if (std::isfinite(_tolerance))
+                tolerance = std::clamp<double>(_tolerance, 1.0e-12, 1.0e-2);
+        }
+
         void update(double dt, int oversampling)
         {
             using namespace std;
 
+            // The adaptive integrator controls its own accuracy, so it ignores `oversampling`.
+            // It only runs forward in time; running backward falls back to RK4.
+            if (integrator == ChaosIntegrator::DormandPrince && dt > 0.0)
+            {
+                adaptiveUpdate(dt);
+                return;
+            }
+            denseValid = false;
+
             // If the derived class has informed us of a maximum stable time increment,
             // use oversampling to keep the actual time increment within that limit:
             // find the smallest positive integer n such that dt/n <= max_dt.
@@ -299,6 +496,8 @@ namespace Sapphire
 
         void step(double dt)
         {
+            denseValid = false;
+
             // Fourth-order Runge-Kutta (RK4) extrapolation.
             SlopeVector k1 = vel(x1, y1, z1);
             SlopeVector k2 = vel(x1 + (dt/2)*k1.mx, y1 + (dt/2)*k1.my, z1 + (dt/2)*k1.mz);
@@ -319,6 +518,7 @@ namespace Sapphire
             x1 = state.x;
             y1 = state.y;
             z1 = state.z;
+            denseValid = false;
         }
     };
 
@@ -435,12 +635,13 @@ namespace Sapphire
     protected:
         SlopeVector slopes(double x, double y, double z) const override
         {
-            const double a = (mode==0) ? KnobValue(knob, aMin, aMax) : 0.95;
-            const double b = (mode==1) ? KnobValue(knob, bMin, bMax) : 0.69535;
-            const double c = (mode==2) ? KnobValue(knob, cMin, cMax) : 0.6029;
-            const double d = 3.5;
-            const double e = (mode==3) ? KnobValue(knob, eMin, eMax) : 0.25;
-            const double f = 0.1;
+            const Coefficients k = coefficients();
+            const double a = k.a;
+            const double b = k.b;
+            const double c = k.c;
+            const double d = k.d;
+            const double e = k.e;
+            const double f = k.f;
 
             return SlopeVector(
                 (z-b)*x - d*y,
@@ -450,6 +651,24 @@ namespace Sapphire
         }
 
     public:
+        struct Coefficients
+        {
+            double a, b, c, d, e, f;
+        };
+
+        Coefficients coefficients() const
+        {
+            // The equation parameters for the current mode and knob setting.
+            return Coefficients {
+                (mode==0) ? KnobValue(knob, aMin, aMax) : 0.95,
+                (mode==1) ? KnobValue(knob, bMin, bMax) : 0.69535,
+                (mode==2) ? KnobValue(knob, cMin, cMax) : 0.6029,
+                3.5,
+                (mode==3) ? KnobValue(knob, eMin, eMax) : 0.25,
+                0.1
+            };
+        }
+
         Aizawa()
             : ChaoticOscillator(
                 0.03,
@@ -8,6 +8,7 @@
 #include <functional>
 #include <utility>
 #include "chaos.hpp"
+#include "sapphire_simd.hpp"
 
 namespace Sapphire
 {
@@ -31,10 +32,111 @@ namespace Sapphire
     static_assert(FilterSeed(0) == ChaosFountainDefaultSeed);
     static_assert(FilterSeed(0xa8a78dac6de3725e) == 0xa8a78dac6de3725e);
 
-    template <unsigned nsignals, typename rand_t = std::mt19937_64>
+    template <unsigned nlanes>
+    class AizawaBatch
+    {
+        // Integrates `nlanes` independent Aizawa oscillators together, 2 per SSE2 register.
+        // Each lane has its own state, coefficients, speed factor, and rate factor.
+        // The RK4 arithmetic is the same as ChaoticOscillator::step, without virtual calls,
+        // so each lane stays exactly the same as stepping its own Aizawa object.
+
+    private:
+        static_assert(nlanes > 0);
+        static constexpr unsigned npairs = (nlanes + 1) / 2;
+
+        struct Pair
+        {
+            DoublePair x, y, z;
+            DoublePair rate;
+            DoublePair speed;
+            DoublePair a, b, c, d, e, f;
+        };
+
+        std::array<Pair, npairs> pair;
+
+        static void vel(
+            const Pair& p,
+            const DoublePair& x, const DoublePair& y, const DoublePair& z,
+            DoublePair& mx, DoublePair& my, DoublePair& mz)
+        {
+            // Same as Aizawa::slopes, scaled by the speed factor.
+            mx = p.speed * ((z-p.b)*x - p.d*y);
+            my = p.speed * (p.d*x + (z-p.b)*y);
+            mz = p.speed * (p.c + p.a*z - z*z*z/3 - (x*x + y*y)*(1 + p.e*z) + p.f*z*x*x*x);
+        }
+
+    public:
+        AizawaBatch()
+        {
+            // Unused padding lanes run a valid oscillator, so they never produce NAN or denormals.
+            const Aizawa osc;
+            for (unsigned lane = 0; lane < 2*npairs; ++lane)
+                load(lane, osc, 1.0);
+        }
+
+        void load(unsigned lane, const Aizawa& osc, double rate)
+        {
+            Pair& p = pair.at(lane / 2);
+            const int i = lane % 2;
+            const ChaoticOscillatorState state = osc.getState();
+            const Aizawa::Coefficients k = osc.coefficients();
+            p.x[i] = state.x;
+            p.y[i] = state.y;
+            p.z[i] = state.z;
+            p.rate[i] = rate;
+            p.speed[i] = osc.getSpeedFactor();
+            p.a[i] = k.a;
+            p.b[i] = k.b;
+            p.c[i] = k.c;
+            p.d[i] = k.d;
+            p.e[i] = k.e;
+            p.f[i] = k.f;
+        }
+
+        ChaoticOscillatorState getState(unsigned lane) const
+        {
+            const Pair& p = pair.at(lane / 2);
+            const int i = lane % 2;
+            return ChaoticOscillatorState(p.x[i], p.y[i], p.z[i]);
+        }
+
+        unsigned step(double dt, unsigned nactive = nlanes)
+        {
+            // Fourth-order Runge-Kutta (RK4) extrapolation, with each lane's time step scaled by its rate.
+            // Only the pairs holding the first `nactive` lanes are stepped.
+            // Returns how many lanes were stepped, which may include one more than requested.
+            const unsigned nstep = std::min(npairs, (nactive + 1) / 2);
+            for (unsigned k = 0; k < nstep; ++k)
+            {
+                Pair& p = pair[k];
+                const DoublePair h = dt * p.rate;
+                const DoublePair h2 = h / 2;
+                const DoublePair h6 = h / 6;
+                DoublePair k1x, k1y, k1z;
+                DoublePair k2x, k2y, k2z;
+                DoublePair k3x, k3y, k3z;
+                DoublePair k4x, k4y, k4z;
+                vel(p, p.x, p.y, p.z, k1x, k1y, k1z);
+                vel(p, p.x + h2*k1x, p.y + h2*k1y, p.z + h2*k1z, k2x, k2y, k2z);
+                vel(p, p.x + h2*k2x, p.y + h2*k2y, p.z + h2*k2z, k3x, k3y, k3z);
+                vel(p, p.x + h*k3x, p.y + h*k3y, p.z + h*k3z, k4x, k4y, k4z);
+                p.x += h6*(k1x + 2*k2x + 2*k3x + k4x);
+                p.y += h6*(k1y + 2*k2y + 2*k3y + k4y);
+                p.z += h6*(k1z + 2*k2z + 2*k3z + k4z);
+            }
+            return std::min(nlanes, 2*nstep);
+        }
+    };
+
+
+    // The signals are shuffled only within consecutive blocks of `shuffleBlock`,
+    // so that a prefix of whole blocks depends only on a prefix of the oscillators.
+    template <unsigned nsignals, typename rand_t = std::mt19937_64, unsigned shuffleBlock = nsignals>
     struct ChaosFountain     // produces an arbitrary number of distinct smooth random curves
     {
     private:
+        static_assert(shuffleBlock > 0 && nsignals % shuffleBlock == 0);
+
         std::uint64_t seed{};
         std::array<unsigned, nsignals> permutation{};
 
@@ -51,15 +153,20 @@ namespace Sapphire
 
         std::array<Aizawa, nTriplets> oscillators{};
         std::array<double, nTriplets> rateFactor{};
+        AizawaBatch<nTriplets> integrator;     // steps all of `oscillators` together
 
         using batch_t = ChaosBatch<nsignals>;
 
         std::uint64_t getSeed() const { return seed; }
 
-        void update(double dt)
+        void update(double dt, unsigned nused = nsignals)
         {
-            for (unsigned i = 0; i < nTriplets; ++i)
-                oscillators[i].step(dt * rateFactor[i]);
+            // When the caller reads only the first `nused` signals, the oscillators
+            // that feed nothing but later blocks are left where they are.
+            const unsigned nblocks = (std::min(nused, nsignals) + shuffleBlock - 1) / shuffleBlock;
+            const unsigned nlanes = integrator.step(dt, (nblocks*shuffleBlock + 2) / 3);
+            for (unsigned i = 0; i < nlanes; ++i)
+                oscillators[i].setState(integrator.getState(i));
         }
 
         batch_t getBatch(float levelKnob) const
@@ -102,6 +209,8 @@ namespace Sapphire
             randomizeChaoticOscillators(gen);
             shuffleSignalMapping(gen);
             randomizeRates(gen);
+            for (unsigned i = 0; i < nTriplets; ++i)
+                integrator.load(i, oscillators[i], rateFactor[i]);
         }
 
         void reset(uint64_t newSeed)
@@ -124,9 +233,10 @@ namespace Sapphire
             for (unsigned i = 0; i < nsignals; ++i)
                 permutation[i] = i;
 
-            for (unsigned i = 1; i < nsignals; ++i)
-                if (unsigned r = gen()%(i+1); r < i)
-                    std::swap(permutation[r], permutation[i]);
+            for (unsigned b = 0; b < nsignals; b += shuffleBlock)
+                for (unsigned i = 1; i < shuffleBlock; ++i)
+                    if (unsigned r = gen()%(i+1); r < i)
+                        std::swap(permutation[b+r], permutation[b+i]);
         }
 
         void randomizeChaoticOscillators(rand_t& gen)
@@ -4,16 +4,19 @@
 
 namespace Sapphire
 {
+    constexpr float COMBFILTER_CLAMP_LIMIT_VOLTS = 6.5;
+    constexpr float COMBFILTER_FEEDBACK_LIMIT = 0.999;
+
     template <typename value_t>
     class CombFilter
     {
     private:
-        static constexpr float CLAMP_LIMIT_VOLTS = 6.5;
-        static constexpr float FEEDBACK_LIMIT = 0.999;
+        static constexpr float CLAMP_LIMIT_VOLTS = COMBFILTER_CLAMP_LIMIT_VOLTS;
+        static constexpr float FEEDBACK_LIMIT = COMBFILTER_FEEDBACK_LIMIT;
         static constexpr int windowSize = 2;
 
-        using interpolator_t = Interpolator<value_t, windowSize>;
-        using delay_t = DelayLine<value_t, 10000>;
+        using interpolator_t = PolyphaseInterpolator<value_t, windowSize>;
+        using delay_t = Pow2DelayLine<value_t, 10000>;
         using filter_t = LoHiPassFilter<value_t>;
 
         delay_t delay;
@@ -83,4 +86,91 @@ namespace Sapphire
             return feedbackSample;
         }
     };
+
+
+    class QuadCombFilter
+    {
+        // Four independent comb filters, one per SIMD lane,
+        // each with its own frequency and resonance.
+        // Every lane produces exactly the same output as CombFilter<float>.
+
+    private:
+        static constexpr float CLAMP_LIMIT_VOLTS = COMBFILTER_CLAMP_LIMIT_VOLTS;
+        static constexpr float FEEDBACK_LIMIT = COMBFILTER_FEEDBACK_LIMIT;
+        static constexpr int windowSize = 2;
+
+        using interpolator_t = PolyphaseInterpolator<float, windowSize>;
+        using delay_t = Pow2DelayLine<PhysicsVector, 10000>;
+        using filter_t = LoHiPassFilter<PhysicsVector>;
+
+        delay_t delay;      // each item holds one sample for all 4 lanes
+        PhysicsVector resonance{};
+        float frequencyVoct[4]{};
+        filter_t dcRejectFilter;
+
+    public:
+        float centerFrequencyHz = C4_FREQUENCY_HZ;
+
+        InterpolatorKind interpKind = InterpolatorKind::Default;
+
+        void initialize()
+        {
+            delay.clear();
+
+            dcRejectFilter.Reset();
+            dcRejectFilter.SetCutoffFrequency(10.0);
+        }
+
+        void setResonance(int lane, float knob)
+        {
+            resonance[lane] = FEEDBACK_LIMIT * std::clamp<float>(knob, -1, +1);
+        }
+
+        void setFrequency(int lane, float knob)
+        {
+            frequencyVoct[lane] = knob;
+        }
+
+        PhysicsVector process(float sampleRateHz, const PhysicsVector& inSample)
+        {
+            dcRejectFilter.Update(inSample, sampleRateHz);
+            PhysicsVector filtSample = dcRejectFilter.HiPass();
+
+            // Each lane reads from its own distance into the past.
+            PhysicsVector oldSample;
+            if (interpKind == InterpolatorKind::Sinc)
+            {
+                for (int i = 0; i < 4; ++i)
+                {
+                    float frequencyHz = TwoToPower(frequencyVoct[i]) * centerFrequencyHz;
+                    float delaySamples = sampleRateHz / frequencyHz;
+                    std::size_t centerSample = static_cast<std::size_t>(std::round(delaySamples));
+                    interpolator_t interp;
+                    for (int w = -windowSize; w <= +windowSize; ++w)
+                        interp.write(w, delay.readBackward(centerSample + w)[i]);
+                    oldSample[i] = interp.read(delaySamples - centerSample);
+                }
+            }
+            else
+            {
+                PhysicsVector s1, s2, mix;
+                for (int i = 0; i < 4; ++i)
+                {
+                    float frequencyHz = TwoToPower(frequencyVoct[i]) * centerFrequencyHz;
+                    float delaySamples = sampleRateHz / frequencyHz;
+                    std::size_t t = static_cast<std::size_t>(std::floor(delaySamples));
+                    s1[i] = delay.readBackward(t)[i];
+                    s2[i] = delay.readBackward(t+1)[i];
+                    mix[i] = delaySamples - t;
+                }
+                oldSample = (1-mix)*s1 + mix*s2;
+            }
+
+            PhysicsVector feedbackSample = filtSample + resonance*oldSample;
+            for (int i = 0; i < 4; ++i)
+                feedbackSample[i] = CLAMP_LIMIT_VOLTS * std::tanh(feedbackSample[i] / CLAMP_LIMIT_VOLTS);
+            delay.write(feedbackSample);
+            return feedbackSample;
+        }
+    };
 }
@@ -685,6 +685,7 @@ namespace Sapphire
             TimeKnob* timeKnob = nullptr;
             TimeKnobInfo timeKnobInfo;
             ToggleGroup reverseToggleGroup;
+            TapeLoopPool tapePool;      // shared by all channels of this module; must be declared before `info`
             ChannelInfo info[PORT_MAX_CHANNELS];
             PolyControls controls;
             TapInputRouting receivedInputRouting{};
@@ -703,10 +704,18 @@ namespace Sapphire
             explicit LoopModule(std::size_t nParams, std::size_t nOutputPorts)
                 : MultiTapModule(nParams, nOutputPorts)
             {
+                for (int c = 0; c < PORT_MAX_CHANNELS; ++c)
+                    info[c].loop.setPool(&tapePool);
                 enableEnvelopeFollower();
                 LoopModule_initialize();
             }
 
+            std::size_t tapeMemoryBytes() const
+            {
+                // Called from the GUI thread: only read the totals the pool publishes atomically.
+                return tapePool.getUsedBytes() + tapePool.getSpareBytes();
+            }
+
             void onRemove(const RemoveEvent& e) override
             {
                 if (graph)
@@ -924,6 +933,7 @@ namespace Sapphire
                 float feedbackSample = 0;
                 int numDeadClocks = 0;
                 int numReceivingTriggers = 0;
+                tapePool.beginFrame();
                 for (int c = 0; c < nc; ++c)
                 {
                     ChannelInfo& q = info[c];
@@ -988,8 +998,10 @@ namespace Sapphire
 
                     delayTimeSum += delayTime;
                     q.loop.setSlewRate(message.tapeSlewRate);
+                    q.loop.setStorage(message.tapeStorage);     // before the tape grows, so it grows in the right format
                     q.loop.setDelayTime(delayTime, sampleRateHz);
                     q.loop.setInterpolatorKind(message.interpolatorKind);
+                    q.loop.setControlRate(message.controlRate);
                     if (clearSmoother.isDelayedActionReady())
                     {
                         q.loop.clear();
@@ -1722,6 +1734,7 @@ namespace Sapphire
                     menu->addChild(loopModule->createToggleAllSensitivityMenuItem());
                     loopModule->addPolyphonicEnvelopeMenuItem(menu);
                     loopModule->reverseToggleGroup.addMenuItems(menu);
+                    menu->addChild(createMenuLabel("Tape memory: " + TapeMemoryText(loopModule->tapeMemoryBytes())));
                 }
             }
 
@@ -1964,6 +1977,8 @@ namespace Sapphire
                 AnimatedTriggerReceiver clearReceiver;
                 RoutingSmoother routingSmoother;
                 InterpolatorKind interpolatorKind{};
+                TapeStorage tapeStorage{};
+                ControlRate controlRate{};
                 Crossfader freezeFader;
                 PortLabelMode inputLabels{};
                 bool autoCreateOutputModule = true;
@@ -2012,6 +2027,8 @@ namespace Sapphire
                     params.at(REVERSE_BUTTON_PARAM).setValue(0);
                     routingSmoother.initialize();
                     interpolatorKind = InterpolatorKind::Linear;
+                    tapeStorage = TapeStorage::Default;
+                    controlRate = ControlRate::Default;
                     freezeToggleGroup.initialize();
                     clearReceiver.initialize();
                     freezeFader.snapToFront();      // front=false=0, back=true=1
@@ -2096,6 +2113,8 @@ namespace Sapphire
                     outMessage.feedback = getFeedbackPoly();
                     timeKnobInfo.isClockConnected = outMessage.isClockConnected = inputs.at(CLOCK_INPUT).isConnected();
                     outMessage.interpolatorKind = interpolatorKind;
+                    outMessage.tapeStorage = tapeStorage;
+                    outMessage.controlRate = controlRate;
                     TapeLoopResult result = updateTapeLoops(outMessage.originalAudio, args.sampleRate, outMessage, inBackMessage);
                     result.globalAudioOutput *= updateMuteState(args.sampleRate, MUTE_BUTTON_PARAM);
                     outMessage.chainAudio = result.chainAudioOutput;
@@ -2130,6 +2149,8 @@ namespace Sapphire
                     routingSmoother.jsonSave(root);
                     freezeToggleGroup.jsonSave(root);
                     jsonSetEnum(root, "interpolatorKind", interpolatorKind);
+                    jsonSetEnum(root, "tapeStorage", tapeStorage);
+                    jsonSetEnum(root, "controlRate", controlRate);
                     jsonSetEnum(root, "clockSignalFormat", clockSignalFormat);
                     jsonSetBool(root, "autoCreateOutputModule", autoCreateOutputModule);
                     tapeSlewQuantity->save(root, "tapeSlewRate");
@@ -2142,6 +2163,8 @@ namespace Sapphire
                     routingSmoother.jsonLoad(root);
                     freezeToggleGroup.jsonLoad(root);
                     jsonLoadEnum(root, "interpolatorKind", interpolatorKind);
+                    jsonLoadEnum(root, "tapeStorage", tapeStorage);
+                    jsonLoadEnum(root, "controlRate", controlRate);
                     jsonLoadEnum(root, "clockSignalFormat", clockSignalFormat);
                     jsonLoadBool(root, "autoCreateOutputModule", autoCreateOutputModule);
                     tapeSlewQuantity->load(root, "tapeSlewRate");
@@ -2586,6 +2609,29 @@ namespace Sapphire
                             echoModule->interpolatorKind
                         ));
 
+                        menu->addChild(CreateChangeEnumMenuItem(
+                            "Tape storage",
+                            {
+                                "32-bit float (best quality)",
+                                "16-bit float (half the memory)",
+                                "16-bit integer (half the memory, noisier on quiet audio, clips at 16V)"
+                            },
+                            "change tape storage",
+                            echoModule->tapeStorage
+                        ));
+
+                        menu->addChild(CreateChangeEnumMenuItem(
+                            "Tape motor control rate",
+                            {
+                                "Every sample",
+                                "Every 4 samples (uses less CPU)",
+                                "Every 16 samples (uses less CPU)",
+                                "Every 32 samples (uses least CPU)"
+                            },
+                            "change tape motor control rate",
+                            echoModule->controlRate
+                        ));
+
                         menu->addChild(createMenuItem(
                             "Toggle all clock sync",
                             "",
@@ -2604,6 +2650,13 @@ namespace Sapphire
                             echoModule->tapeSlewQuantity,
                             "change tape speed limit"
                         ));
+
+                        std::size_t chainBytes = 0;
+                        visitTaps([&chainBytes](const LoopModule* lmod)
+                        {
+                            chainBytes += lmod->tapeMemoryBytes();
+                        });
+                        menu->addChild(createMenuLabel("Tape memory for all taps: " + TapeMemoryText(chainBytes)));
                     }
                 }
 
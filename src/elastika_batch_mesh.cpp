@@ -0,0 +1,425 @@
+//****  GENERATED CODE  ****  DO NOT EDIT  *****
+
+#include "elastika_batch_mesh.hpp"
+
+namespace Sapphire
+{
+    ElastikaBatchMesh::ElastikaBatchMesh()
+        : PhysicsMesh(34, 22)
+    {
+        AddBall(  1e-06,   0.001,              0, 0);   //  0
+        AddBall(  1e-06,  0.0005,   0.0008660255, 0);   //  1
+        AddBall(  1e-06, -0.0005,   0.0008660255, 0);   //  2
+        AddBall(  1e-06,  -0.001,              0, 0);   //  3
+        AddBall(  1e-06, -0.0005,  -0.0008660255, 0);   //  4
+        AddBall(  1e-06,  0.0005,  -0.0008660255, 0);   //  5
+        AddBall(  1e-06,  0.0025,   0.0008660255, 0);   //  6
+        AddBall(  1e-06,   0.002,    0.001732051, 0);   //  7
+        AddBall(  1e-06,   0.001,    0.001732051, 0);   //  8
+        AddBall(  1e-06,   0.002,              0, 0);   //  9
+        AddBall(  1e-06,   0.004,    0.001732051, 0);   // 10
+        AddBall(  1e-06,  0.0035,    0.002598076, 0);   // 11
+        AddBall(  1e-06,  0.0025,    0.002598076, 0);   // 12
+        AddBall(  1e-06,  0.0035,   0.0008660255, 0);   // 13
+        AddBall(  1e-06,   0.001,   -0.001732051, 0);   // 14
+        AddBall(  1e-06,  -0.001,   -0.001732051, 0);   // 15
+        AddBall(  1e-06, -0.0005,   -0.002598076, 0);   // 16
+        AddBall(  1e-06,  0.0005,   -0.002598076, 0);   // 17
+        AddBall(  1e-06,  0.0025,  -0.0008660255, 0);   // 18
+        AddBall(  1e-06,   0.002,   -0.001732051, 0);   // 19
+        AddBall(  1e-06,   0.004,              0, 0);   // 20
+        AddBall(  1e-06,  0.0035,  -0.0008660255, 0);   // 21
+        AddBall(     -1,  -0.002,              0, 0);   // 22
+        AddBall(     -1,  -0.001,    0.001732051, 0);   // 23
+        AddBall(     -1,  -0.002,   -0.001732051, 0);   // 24
+        AddBall(     -1,  0.0005,    0.002598076, 0);   // 25
+        AddBall(     -1,  -0.001,   -0.003464102, 0);   // 26
+        AddBall(     -1,   0.002,    0.003464102, 0);   // 27
+        AddBall(     -1,   0.001,   -0.003464102, 0);   // 28
+        AddBall(     -1,   0.004,    0.003464102, 0);   // 29
+        AddBall(     -1,  0.0025,   -0.002598076, 0);   // 30
+        AddBall(     -1,   0.005,    0.001732051, 0);   // 31
+        AddBall(     -1,   0.004,   -0.001732051, 0);   // 32
+        AddBall(     -1,   0.005,              0, 0);   // 33
+    }
+
+    void ElastikaBatchMesh::Dampen(float damp)
+    {
+        currBallList[ 0].vel *= damp;
+        currBallList[ 1].vel *= damp;
+        currBallList[ 2].vel *= damp;
+        currBallList[ 3].vel *= damp;
+        currBallList[ 4].vel *= damp;
+        currBallList[ 5].vel *= damp;
+        currBallList[ 6].vel *= damp;
+        currBallList[ 7].vel *= damp;
+        currBallList[ 8].vel *= damp;
+        currBallList[ 9].vel *= damp;
+        currBallList[10].vel *= damp;
+        currBallList[11].vel *= damp;
+        currBallList[12].vel *= damp;
+        currBallList[13].vel *= damp;
+        currBallList[14].vel *= damp;
+        currBallList[15].vel *= damp;
+        currBallList[16].vel *= damp;
+        currBallList[17].vel *= damp;
+        currBallList[18].vel *= damp;
+        currBallList[19].vel *= damp;
+        currBallList[20].vel *= damp;
+        currBallList[21].vel *= damp;
+    }
+
+    void ElastikaBatchMesh::CalcForces(const BallList& blist)
+    {
+        forceList[0] = Cross(blist[0].vel, magnet);
+        forceList[1] = Cross(blist[1].vel, magnet);
+        forceList[2] = Cross(blist[2].vel, magnet);
+        forceList[3] = Cross(blist[3].vel, magnet);
+        forceList[4] = Cross(blist[4].vel, magnet);
+        forceList[5] = Cross(blist[5].vel, magnet);
+        forceList[6] = Cross(blist[6].vel, magnet);
+        forceList[7] = Cross(blist[7].vel, magnet);
+        forceList[8] = Cross(blist[8].vel, magnet);
+        forceList[9] = Cross(blist[9].vel, magnet);
+        forceList[10] = Cross(blist[10].vel, magnet);
+        forceList[11] = Cross(blist[11].vel, magnet);
+        forceList[12] = Cross(blist[12].vel, magnet);
+        forceList[13] = Cross(blist[13].vel, magnet);
+        forceList[14] = Cross(blist[14].vel, magnet);
+        forceList[15] = Cross(blist[15].vel, magnet);
+        forceList[16] = Cross(blist[16].vel, magnet);
+        forceList[17] = Cross(blist[17].vel, magnet);
+        forceList[18] = Cross(blist[18].vel, magnet);
+        forceList[19] = Cross(blist[19].vel, magnet);
+        forceList[20] = Cross(blist[20].vel, magnet);
+        forceList[21] = Cross(blist[21].vel, magnet);
+
+        SpringForceBatch batch = CalcSpringForces(stiffness, restLength,
+            blist[ 2].pos - blist[ 3].pos,
+            blist[22].pos - blist[ 3].pos,
+            blist[ 4].pos - blist[ 3].pos,
+            blist[ 1].pos - blist[ 2].pos);
+        forceList[ 3] += batch.force[0];
+        forceList[ 2] -= batch.force[0];
+        forceList[ 3] += batch.force[1];
+        forceList[ 3] += batch.force[2];
+        forceList[ 4] -= batch.force[2];
+        forceList[ 2] += batch.force[3];
+        forceList[ 1] -= batch.force[3];
+
+        batch = CalcSpringForces(stiffness, restLength,
+            blist[23].pos - blist[ 2].pos,
+            blist[ 4].pos - blist[15].pos,
+            blist[24].pos - blist[15].pos,
+            blist[16].pos - blist[15].pos);
+        forceList[ 2] += batch.force[0];
+        forceList[15] += batch.force[1];
+        forceList[ 4] -= batch.force[1];
+        forceList[15] += batch.force[2];
+        forceList[15] += batch.force[3];
+        forceList[16] -= batch.force[3];
+
+        batch = CalcSpringForces(stiffness, restLength,
+            blist[ 5].pos - blist[ 4].pos,
+            blist[ 8].pos - blist[ 1].pos,
+            blist[ 0].pos - blist[ 1].pos,
+            blist[ 7].pos - blist[ 8].pos);
+        forceList[ 4] += batch.force[0];
+        forceList[ 5] -= batch.force[0];
+        forceList[ 1] += batch.force[1];
+        forceList[ 8] -= batch.force[1];
+        forceList[ 1] += batch.force[2];
+        forceList[ 0] -= batch.force[2];
+        forceList[ 8] += batch.force[3];
+        forceList[ 7] -= batch.force[3];
+
+        batch = CalcSpringForces(stiffness, restLength,
+            blist[25].pos - blist[ 8].pos,
+            blist[17].pos - blist[16].pos,
+            blist[26].pos - blist[16].pos,
+            blist[ 0].pos - blist[ 5].pos);
+        forceList[ 8] += batch.force[0];
+        forceList[16] += batch.force[1];
+        forceList[17] -= batch.force[1];
+        forceList[16] += batch.force[2];
+        forceList[ 5] += batch.force[3];
+        forceList[ 0] -= batch.force[3];
+
+        batch = CalcSpringForces(stiffness, restLength,
+            blist[14].pos - blist[ 5].pos,
+            blist[ 9].pos - blist[ 0].pos,
+            blist[12].pos - blist[ 7].pos,
+            blist[ 6].pos - blist[ 7].pos);
+        forceList[ 5] += batch.force[0];
+        forceList[14] -= batch.force[0];
+        forceList[ 0] += batch.force[1];
+        forceList[ 9] -= batch.force[1];
+        forceList[ 7] += batch.force[2];
+        forceList[12] -= batch.force[2];
+        forceList[ 7] += batch.force[3];
+        forceList[ 6] -= batch.force[3];
+
+        batch = CalcSpringForces(stiffness, restLength,
+            blist[11].pos - blist[12].pos,
+            blist[27].pos - blist[12].pos,
+            blist[14].pos - blist[17].pos,
+            blist[28].pos - blist[17].pos);
+        forceList[12] += batch.force[0];
+        forceList[11] -= batch.force[0];
+        forceList[12] += batch.force[1];
+        forceList[17] += batch.force[2];
+        forceList[14] -= batch.force[2];
+        forceList[17] += batch.force[3];
+
+        batch = CalcSpringForces(stiffness, restLength,
+            blist[19].pos - blist[14].pos,
+            blist[ 6].pos - blist[ 9].pos,
+            blist[18].pos - blist[ 9].pos,
+            blist[13].pos - blist[ 6].pos);
+        forceList[14] += batch.force[0];
+        forceList[19] -= batch.force[0];
+        forceList[ 9] += batch.force[1];
+        forceList[ 6] -= batch.force[1];
+        forceList[ 9] += batch.force[2];
+        forceList[18] -= batch.force[2];
+        forceList[ 6] += batch.force[3];
+        forceList[13] -= batch.force[3];
+
+        batch = CalcSpringForces(stiffness, restLength,
+            blist[29].pos - blist[11].pos,
+            blist[10].pos - blist[11].pos,
+            blist[18].pos - blist[19].pos,
+            blist[30].pos - blist[19].pos);
+        forceList[11] += batch.force[0];
+        forceList[11] += batch.force[1];
+        forceList[10] -= batch.force[1];
+        forceList[19] += batch.force[2];
+        forceList[18] -= batch.force[2];
+        forceList[19] += batch.force[3];
+
+        batch = CalcSpringForces(stiffness, restLength,
+            blist[21].pos - blist[18].pos,
+            blist[10].pos - blist[13].pos,
+            blist[20].pos - blist[13].pos,
+            blist[31].pos - blist[10].pos);
+        forceList[18] += batch.force[0];
+        forceList[21] -= batch.force[0];
+        forceList[13] += batch.force[1];
+        forceList[10] -= batch.force[1];
+        forceList[13] += batch.force[2];
+        forceList[20] -= batch.force[2];
+        forceList[10] += batch.force[3];
+
+        batch = CalcSpringForces(stiffness, restLength,
+            blist[20].pos - blist[21].pos,
+            blist[32].pos - blist[21].pos,
+            blist[33].pos - blist[20].pos,
+            PhysicsVector::zero());
+        forceList[21] += batch.force[0];
+        forceList[20] -= batch.force[0];
+        forceList[21] += batch.force[1];
+        forceList[20] += batch.force[2];
+    }
+
+    void ElastikaBatchMesh::Extrapolate(float dt)
+    {
+        const float speedLimitSquared = speedLimit * speedLimit;
+        const Ball* curr = currBallList.data();
+        Ball* next = nextBallList.data();
+        float speedSquared;
+
+        next->vel = curr->vel + ((dt / curr->mass) * forceList[0]);
+        speedSquared = Quadrature(next->vel);
+        if (speedSquared > speedLimitSquared)
+            next->vel *= speedLimit / std::sqrt(speedSquared);
+        next->pos = curr->pos + ((dt/2) * (curr->vel + next->vel));
+        ++curr;
+        ++next;
+
+        next->vel = curr->vel + ((dt / curr->mass) * forceList[1]);
+        speedSquared = Quadrature(next->vel);
+        if (speedSquared > speedLimitSquared)
+            next->vel *= speedLimit / std::sqrt(speedSquared);
+        next->pos = curr->pos + ((dt/2) * (curr->vel + next->vel));
+        ++curr;
+        ++next;
+
+        next->vel = curr->vel + ((dt / curr->mass) * forceList[2]);
+        speedSquared = Quadrature(next->vel);
+        if (speedSquared > speedLimitSquared)
+            next->vel *= speedLimit / std::sqrt(speedSquared);
+        next->pos = curr->pos + ((dt/2) * (curr->vel + next->vel));
+        ++curr;
+        ++next;
+
+        next->vel = curr->vel + ((dt / curr->mass) * forceList[3]);
+        speedSquared = Quadrature(next->vel);
+        if (speedSquared > speedLimitSquared)
+            next->vel *= speedLimit / std::sqrt(speedSquared);
+        next->pos = curr->pos + ((dt/2) * (curr->vel + next->vel));
+        ++curr;
+        ++next;
+
+        next->vel = curr->vel + ((dt / curr->mass) * forceList[4]);
+        speedSquared = Quadrature(next->vel);
+        if (speedSquared > speedLimitSquared)
+            next->vel *= speedLimit / std::sqrt(speedSquared);
+        next->pos = curr->pos + ((dt/2) * (curr->vel + next->vel));
+        ++curr;
+        ++next;
+
+        next->vel = curr->vel + ((dt / curr->mass) * forceList[5]);
+        speedSquared = Quadrature(next->vel);
+        if (speedSquared > speedLimitSquared)
+            next->vel *= speedLimit / std::sqrt(speedSquared);
+        next->pos = curr->pos + ((dt/2) * (curr->vel + next->vel));
+        ++curr;
+        ++next;
+
+        next->vel = curr->vel + ((dt / curr->mass) * forceList[6]);
+        speedSquared = Quadrature(next->vel);
+        if (speedSquared > speedLimitSquared)
+            next->vel *= speedLimit / std::sqrt(speedSquared);
+        next->pos = curr->pos + ((dt/2) * (curr->vel + next->vel));
+        ++curr;
+        ++next;
+
+        next->vel = curr->vel + ((dt / curr->mass) * forceList[7]);
+        speedSquared = Quadrature(next->vel);
+        if (speedSquared > speedLimitSquared)
+            next->vel *= speedLimit / std::sqrt(speedSquared);
+        next->pos = curr->pos + ((dt/2) * (curr->vel + next->vel));
+        ++curr;
+        ++next;
+
+        next->vel = curr->vel + ((dt / curr->mass) * forceList[8]);
+        speedSquared = Quadrature(next->vel);
+        if (speedSquared > speedLimitSquared)
+            next->vel *= speedLimit / std::sqrt(speedSquared);
+        next->pos = curr->pos + ((dt/2) * (curr->vel + next->vel));
+        ++curr;
+        ++next;
+
+        next->vel = curr->vel + ((dt / curr->mass) * forceList[9]);
+        speedSquared = Quadrature(next->vel);
+        if (speedSquared > speedLimitSquared)
+            next->vel *= speedLimit / std::sqrt(speedSquared);
+        next->pos = curr->pos + ((dt/2) * (curr->vel + next->vel));
+        ++curr;
+        ++next;
+
+        next->vel = curr->vel + ((dt / curr->mass) * forceList[10]);
+        speedSquared = Quadrature(next->vel);
+        if (speedSquared > speedLimitSquared)
+            next->vel *= speedLimit / std::sqrt(speedSquared);
+        next->pos = curr->pos + ((dt/2) * (curr->vel + next->vel));
+        ++curr;
+        ++next;
+
+        next->vel = curr->vel + ((dt / curr->mass) * forceList[11]);
+        speedSquared = Quadrature(next->vel);
+        if (speedSquared > speedLimitSquared)
+            next->vel *= speedLimit / std::sqrt(speedSquared);
+        next->pos = curr->pos + ((dt/2) * (curr->vel + next->vel));
+        ++curr;
+        ++next;
+
+        next->vel = curr->vel + ((dt / curr->mass) * forceList[12]);
+        speedSquared = Quadrature(next->vel);
+        if (speedSquared > speedLimitSquared)
+            next->vel *= speedLimit / std::sqrt(speedSquared);
+        next->pos = curr->pos + ((dt/2) * (curr->vel + next->vel));
+        ++curr;
+        ++next;
+
+        next->vel = curr->vel + ((dt / curr->mass) * forceList[13]);
+        speedSquared = Quadrature(next->vel);
+        if (speedSquared > speedLimitSquared)
+            next->vel *= speedLimit / std::sqrt(speedSquared);
+        next->pos = curr->pos + ((dt/2) * (curr->vel + next->vel));
+        ++curr;
+        ++next;
+
+        next->vel = curr->vel + ((dt / curr->mass) * forceList[14]);
+        speedSquared = Quadrature(next->vel);
+        if (speedSquared > speedLimitSquared)
+            next->vel *= speedLimit / std::sqrt(speedSquared);
+        next->pos = curr->pos + ((dt/2) * (curr->vel + next->vel));
+        ++curr;
+        ++next;
+
+        next->vel = curr->vel + ((dt / curr->mass) * forceList[15]);
+        speedSquared = Quadrature(next->vel);
+        if (speedSquared > speedLimitSquared)
+            next->vel *= speedLimit / std::sqrt(speedSquared);
+        next->pos = curr->pos + ((dt/2) * (curr->vel + next->vel));
+        ++curr;
+        ++next;
+
+        next->vel = curr->vel + ((dt / curr->mass) * forceList[16]);
+        speedSquared = Quadrature(next->vel);
+        if (speedSquared > speedLimitSquared)
+            next->vel *= speedLimit / std::sqrt(speedSquared);
+        next->pos = curr->pos + ((dt/2) * (curr->vel + next->vel));
+        ++curr;
+        ++next;
+
+        next->vel = curr->vel + ((dt / curr->mass) * forceList[17]);
+        speedSquared = Quadrature(next->vel);
+        if (speedSquared > speedLimitSquared)
+            next->vel *= speedLimit / std::sqrt(speedSquared);
+        next->pos = curr->pos + ((dt/2) * (curr->vel + next->vel));
+        ++curr;
+        ++next;
+
+        next->vel = curr->vel + ((dt / curr->mass) * forceList[18]);
+        speedSquared = Quadrature(next->vel);
+        if (speedSquared > speedLimitSquared)
+            next->vel *= speedLimit / std::sqrt(speedSquared);
+        next->pos = curr->pos + ((dt/2) * (curr->vel + next->vel));
+        ++curr;
+        ++next;
+
+        next->vel = curr->vel + ((dt / curr->mass) * forceList[19]);
+        speedSquared = Quadrature(next->vel);
+        if (speedSquared > speedLimitSquared)
+            next->vel *= speedLimit / std::sqrt(speedSquared);
+        next->pos = curr->pos + ((dt/2) * (curr->vel + next->vel));
+        ++curr;
+        ++next;
+
+        next->vel = curr->vel + ((dt / curr->mass) * forceList[20]);
+        speedSquared = Quadrature(next->vel);
+        if (speedSquared > speedLimitSquared)
+            next->vel *= speedLimit / std::sqrt(speedSquared);
+        next->pos = curr->pos + ((dt/2) * (curr->vel + next->vel));
+        ++curr;
+        ++next;
+
+        next->vel = curr->vel + ((dt / curr->mass) * forceList[21]);
+        speedSquared = Quadrature(next->vel);
+        if (speedSquared > speedLimitSquared)
+            next->vel *= speedLimit / std::sqrt(speedSquared);
+        next->pos = curr->pos + ((dt/2) * (curr->vel + next->vel));
+    }
+
+    MeshAudioParameters ElastikaBatchMesh::getAudioParameters()
+    {
+        MeshAudioParameters mp;
+        mp.leftInputBallIndex = 23;
+        mp.rightInputBallIndex = 32;
+        mp.leftOutputBallIndex = 12;
+        mp.rightOutputBallIndex = 17;
+        mp.leftVarMassBallIndex = 6;
+        mp.rightVarMassBallIndex = 5;
+        mp.leftInputDir1 = PhysicsVector{0, 0, 0.0001, 0};
+        mp.leftInputDir2 = PhysicsVector{7e-05, -7e-05, 0, 0};
+        mp.rightInputDir1 = PhysicsVector{0, 0, 0.0001, 0};
+        mp.rightInputDir2 = PhysicsVector{-7e-05, 7e-05, 0, 0};
+        mp.leftOutputDir1 = PhysicsVector{0, 0, 6000, 0};
+        mp.leftOutputDir2 = PhysicsVector{0, -6000, 0, 0};
+        mp.rightOutputDir1 = PhysicsVector{0, 0, 6000, 0};
+        mp.rightOutputDir2 = PhysicsVector{0, 6000, 0, 0};
+        return mp;
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "mesh_physics.hpp"
+
+namespace Sapphire
+{
+    // ElastikaBatchMesh simulates the same mesh as ElastikaMesh, producing the same audio.
+    // Its generated force calculator evaluates springs 4 at a time with CalcSpringForces,
+    // instead of calculating a square root, a division, and a branch for every spring.
+
+    class ElastikaBatchMesh : public PhysicsMesh
+    {
+    public:
+        ElastikaBatchMesh();
+        static MeshAudioParameters getAudioParameters();
+
+        static float DampingFactor(float dt, float halflife)
+        {
+            return OneHalfToPower(dt/halflife);
+        }
+
+        void Update(float dt, float halflife)
+        {
+            Step(dt, DampingFactor(dt, halflife));
+        }
+
+        void Step(float dt, float damp)     // `damp` must be the value returned by DampingFactor(dt, halflife)
+        {
+            Dampen(damp);
+            CalcForces(currBallList);
+            Extrapolate(dt/2);
+            CalcForces(nextBallList);
+            Extrapolate(dt);
+            std::swap(nextBallList, currBallList);
+        }
+
+    private:
+        void Dampen(float damp);
+        void CalcForces(const BallList& blist);
+        void Extrapolate(float dt);
+    };
+}
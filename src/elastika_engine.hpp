@@ -1,6 +1,7 @@
 #pragma once
 #include <algorithm>
 #include "elastika_mesh.hpp"
+#include "elastika_batch_mesh.hpp"
 
 // Sapphire mesh physics engine, by Don Cross <cosinekitty@gmail.com>
 // https://github.com/cosinekitty/sapphire
@@ -9,6 +10,44 @@ namespace Sapphire
 {
     const int ELASTIKA_FILTER_LAYERS = 3;
 
+    // Conversions from Elastika's slider values to physical mesh parameters.
+    // These are shared by the monophonic and polyphonic Elastika engines.
+
+    inline float ElastikaHalfLife(float frictionSlider)
+    {
+        float x = std::clamp(frictionSlider, 0.0f, 1.0f);
+        return TenToPower(-4.5f*x + 1.3f);
+    }
+
+    inline float ElastikaRestLength(float spanSlider)
+    {
+        return 0.0003f*std::clamp(spanSlider, 0.0f, 1.0f) + 0.0008f;
+    }
+
+    inline float ElastikaStiffness(float stiffnessSlider)
+    {
+        float x = std::clamp(stiffnessSlider, 0.0f, 1.0f);
+        return TenToPower(3.4f*x - 0.1f);
+    }
+
+    inline PhysicsVector ElastikaMagneticField(float curlSlider)
+    {
+        float curl = std::clamp(curlSlider, -1.0f, +1.0f);
+        if (curl >= 0.0f)
+            return curl * PhysicsVector(0.015, 0, 0, 0);
+        return curl * PhysicsVector(0, 0, -0.015, 0);
+    }
+
+    inline float ElastikaBallMass(float massSlider)
+    {
+        return TenToPower(std::clamp(massSlider, -1.0f, +1.0f) - 6);
+    }
+
+    inline float ElastikaLevel(float slider)   // min = 0.0 (-inf dB), default = 1.0 (0 dB), max = 2.0 (+24 dB)
+    {
+        return FourthPower(std::clamp(slider, 0.0f, 2.0f));
+    }
+
     class MeshInput     // facilitates injecting audio into the mesh
     {
     private:
@@ -24,7 +63,8 @@ namespace Sapphire
             {}
 
         // Inject audio into the mesh
-        void Inject(PhysicsMesh& mesh, const PhysicsVector& direction, float sample)
+        template <typename mesh_t>
+        void Inject(mesh_t& mesh, const PhysicsVector& direction, float sample)
         {
             PhysicsVector pos = mesh.GetBallOrigin(ballIndex) + (sample * direction);
             mesh.SetBallPosition(ballIndex, pos);
@@ -47,24 +87,30 @@ namespace Sapphire
             {}
 
         // Extract audio from the mesh
-        float Extract(const PhysicsMesh& mesh, const PhysicsVector& direction) const
+        template <typename mesh_t>
+        float Extract(const mesh_t& mesh, const PhysicsVector& direction) const
         {
             PhysicsVector movement = mesh.GetBallDisplacement(ballIndex);
             return Dot(movement, direction);
         }
 
-        PhysicsVector VectorDisplacement(const PhysicsMesh& mesh) const
+        template <typename mesh_t>
+        PhysicsVector VectorDisplacement(const mesh_t& mesh) const
         {
             return BallPositionFactor * mesh.GetBallDisplacement(ballIndex);
         }
     };
 
 
-    class ElastikaEngine
+    // The mesh type `mesh_t` may be ElastikaMesh (generated unrolled scalar code),
+    // ElastikaBatchMesh (generated code evaluating 4 springs at a time),
+    // or a mesh built at runtime, e.g. RuntimeMesh.
+    template <typename mesh_t>
+    class ElastikaEngineBase
     {
     private:
         int outputVerifyCounter;
-        ElastikaMesh mesh;
+        mesh_t mesh;
         const MeshAudioParameters mp;
         MeshInput leftInput;
         MeshInput rightInput;
@@ -75,15 +121,72 @@ namespace Sapphire
         float halfLife;
         float drive;
         float gain;
-        float inTilt;
-        float outTilt;
+        float inTilt = -1;      // out-of-range value forces the first setInputTilt() to calculate directions
+        float outTilt = -1;     // out-of-range value forces the first setOutputTilt() to calculate directions
+        PhysicsVector leftInputDir;
+        PhysicsVector rightInputDir;
+        PhysicsVector leftOutputDir;
+        PhysicsVector rightOutputDir;
         float mix;
         AutomaticGainLimiter agc;
         bool enableAgc = false;
 
+        bool processFrame(float sampleRate, float dt, float damp, float leftIn, float rightIn, float& leftOut, float& rightOut)
+        {
+            // Feed audio stimulus into the mesh.
+            leftInput.Inject(mesh, leftInputDir, drive * leftIn);
+            rightInput.Inject(mesh, rightInputDir, drive * rightIn);
+
+            // Update the simulation state by one sample's worth of time.
+            mesh.Step(dt, damp);
+
+            // Extract output for the left channel.
+            leftOut = leftOutput.Extract(mesh, leftOutputDir);
+            leftOut = leftLoCut.UpdateHiPass(leftOut, sampleRate);
+            leftOut = CubicMix(mix, leftIn, gain * leftOut);
+
+            // Extract output for the right channel.
+            rightOut = rightOutput.Extract(mesh, rightOutputDir);
+            rightOut = rightLoCut.UpdateHiPass(rightOut, sampleRate);
+            rightOut = CubicMix(mix, rightIn, gain * rightOut);
+
+            if (enableAgc)
+            {
+                // Automatic gain control to limit excessive output voltages.
+                agc.process(sampleRate, leftOut, rightOut);
+            }
+
+            // Final line of defense against NAN/infinite output:
+            // Check for invalid output. If found, clear the mesh.
+            // Do this about every quarter of a second, to avoid CPU burden.
+            // The intention is for the user to notice something sounds wrong,
+            // the output is briefly NAN, but then it clears up as soon as the
+            // internal or external problem is resolved.
+            // The main point is to avoid leaving Elastika stuck in a NAN state forever.
+            if (++outputVerifyCounter >= 11000)
+            {
+                outputVerifyCounter = 0;
+                if (!std::isfinite(leftOut) || !std::isfinite(rightOut))
+                {
+                    quiet();
+                    leftOut = rightOut = 0;
+                    return false;   // non-finite output detected
+                }
+            }
+
+            return true;    // output is OK
+        }
+
     public:
-        ElastikaEngine()
-            : mp(ElastikaMesh::getAudioParameters())
+        ElastikaEngineBase()
+            : mp(mesh.getAudioParameters())
+        {
+            initialize();
+        }
+
+        explicit ElastikaEngineBase(const mesh_t& _mesh)     // for meshes built at runtime, e.g. RuntimeMesh
+            : mesh(_mesh)
+            , mp(mesh.getAudioParameters())
         {
             initialize();
         }
@@ -132,57 +235,62 @@ namespace Sapphire
 
         void setFriction(float slider = 0.5f)
         {
-            float x = std::clamp(slider, 0.0f, 1.0f);
-            halfLife = TenToPower(-4.5f*x + 1.3f);
+            halfLife = ElastikaHalfLife(slider);
         }
 
         void setSpan(float slider = 0.5f)
         {
-            float restLength = 0.0003f*std::clamp(slider, 0.0f, 1.0f) + 0.0008f;
-            mesh.SetRestLength(restLength);
+            mesh.SetRestLength(ElastikaRestLength(slider));
         }
 
         void setStiffness(float slider = 0.5f)
         {
-            float x = std::clamp(slider, 0.0f, 1.0f);
-            float stiffness = TenToPower(3.4f*x - 0.1f);
-            mesh.SetStiffness(stiffness);
+            mesh.SetStiffness(ElastikaStiffness(slider));
         }
 
         void setCurl(float slider = 0.0f)
         {
-            float curl = std::clamp(slider, -1.0f, +1.0f);
-            if (curl >= 0.0f)
-                mesh.SetMagneticField(curl * PhysicsVector(0.015, 0, 0, 0));
-            else
-                mesh.SetMagneticField(curl * PhysicsVector(0, 0, -0.015, 0));
+            mesh.SetMagneticField(ElastikaMagneticField(slider));
         }
 
         void setMass(float slider = 0.0f)
         {
-            const float mass = TenToPower(std::clamp(slider, -1.0f, +1.0f) - 6);
+            const float mass = ElastikaBallMass(slider);
             mesh.SetBallMass(mp.leftVarMassBallIndex, mass);
             mesh.SetBallMass(mp.rightVarMassBallIndex, mass);
         }
 
         void setDrive(float slider = 1.0f)      // min = 0.0 (-inf dB), default = 1.0 (0 dB), max = 2.0 (+24 dB)
         {
-            drive = FourthPower(std::clamp(slider, 0.0f, 2.0f));
+            drive = ElastikaLevel(slider);
         }
 
         void setGain(float slider = 1.0f)      // min = 0.0 (-inf dB), default = 1.0 (0 dB), max = 2.0 (+24 dB)
         {
-            gain = FourthPower(std::clamp(slider, 0.0f, 2.0f));
+            gain = ElastikaLevel(slider);
         }
 
         void setInputTilt(float slider = 0.5f)
         {
-            inTilt = std::clamp(slider, 0.0f, 1.0f);
+            // Interpolating the direction vectors is expensive, so do it only when the tilt changes.
+            float tilt = std::clamp(slider, 0.0f, 1.0f);
+            if (tilt != inTilt)
+            {
+                inTilt = tilt;
+                leftInputDir  = Interpolate(inTilt, mp.leftInputDir1,  mp.leftInputDir2);
+                rightInputDir = Interpolate(inTilt, mp.rightInputDir1, mp.rightInputDir2);
+            }
         }
 
         void setOutputTilt(float slider = 0.5f)
         {
-            outTilt = std::clamp(slider, 0.0f, 1.0f);
+            float tilt = std::clamp(slider, 0.0f, 1.0f);
+            if (tilt != outTilt)
+            {
+                outTilt = tilt;
+                leftOutputDir  = Interpolate(outTilt, mp.leftOutputDir1,  mp.leftOutputDir2);
+                rightOutputDir = Interpolate(outTilt, mp.rightOutputDir1, mp.rightOutputDir2);
+            }
         }
 
         void setMix(float slider = 1.0f)
@@ -217,52 +325,27 @@ namespace Sapphire
 
         bool process(float sampleRate, float leftIn, float rightIn, float& leftOut, float& rightOut)
         {
-            // Feed audio stimulus into the mesh.
-            PhysicsVector leftInputDir = Interpolate(inTilt, mp.leftInputDir1, mp.leftInputDir2);
-            PhysicsVector rightInputDir = Interpolate(inTilt, mp.rightInputDir1, mp.rightInputDir2);
-            leftInput.Inject(mesh, leftInputDir, drive * leftIn);
-            rightInput.Inject(mesh, rightInputDir, drive * rightIn);
-
-            // Update the simulation state by one sample's worth of time.
-            mesh.Update(1/sampleRate, halfLife);
-
-            // Extract output for the left channel.
-            PhysicsVector leftOutputDir = Interpolate(outTilt, mp.leftOutputDir1, mp.leftOutputDir2);
-            leftOut = leftOutput.Extract(mesh, leftOutputDir);
-            leftOut = leftLoCut.UpdateHiPass(leftOut, sampleRate);
-            leftOut = CubicMix(mix, leftIn, gain * leftOut);
-
-            // Extract output for the right channel.
-            PhysicsVector rightOutputDir = Interpolate(outTilt, mp.rightOutputDir1, mp.rightOutputDir2);
-            rightOut = rightOutput.Extract(mesh, rightOutputDir);
-            rightOut = rightLoCut.UpdateHiPass(rightOut, sampleRate);
-            rightOut = CubicMix(mix, rightIn, gain * rightOut);
-
-            if (enableAgc)
-            {
-                // Automatic gain control to limit excessive output voltages.
-                agc.process(sampleRate, leftOut, rightOut);
-            }
-
-            // Final line of defense against NAN/infinite output:
-            // Check for invalid output. If found, clear the mesh.
-            // Do this about every quarter of a second, to avoid CPU burden.
-            // The intention is for the user to notice something sounds wrong,
-            // the output is briefly NAN, but then it clears up as soon as the
-            // internal or external problem is resolved.
-            // The main point is to avoid leaving Elastika stuck in a NAN state forever.
-            if (++outputVerifyCounter >= 11000)
-            {
-                outputVerifyCounter = 0;
-                if (!std::isfinite(leftOut) || !std::isfinite(rightOut))
-                {
-                    quiet();
-                    leftOut = rightOut = 0;
-                    return false;   // non-finite output detected
-                }
-            }
+            const float dt = 1/sampleRate;
+            return processFrame(sampleRate, dt, mesh_t::DampingFactor(dt, halfLife), leftIn, rightIn, leftOut, rightOut);
+        }
 
-            return true;    // output is OK
+        bool processBlock(
+            float sampleRate,
+            const float* leftIn,
+            const float* rightIn,
+            float* leftOut,
+            float* rightOut,
+            std::size_t nframes)
+        {
+            // Produces output identical to calling process() once per frame,
+            // but calculates values that are invariant over the block only once.
+            const float dt = 1/sampleRate;
+            const float damp = mesh_t::DampingFactor(dt, halfLife);
+            bool ok = true;
+            for (std::size_t i = 0; i < nframes; ++i)
+                if (!processFrame(sampleRate, dt, damp, leftIn[i], rightIn[i], leftOut[i], rightOut[i]))
+                    ok = false;
+            return ok;
         }
 
         PhysicsVector getOutputVector(bool right) const
@@ -274,4 +357,6 @@ namespace Sapphire
             return scalar * output.VectorDisplacement(mesh);
         }
     };
+
+    using ElastikaEngine = ElastikaEngineBase<ElastikaBatchMesh>;
 }
@@ -43,9 +43,8 @@ namespace Sapphire
         AddBall(     -1,   0.005,              0, 0);   // 33
     }
 
-    void ElastikaMesh::Dampen(float dt, float halflife)
+    void ElastikaMesh::Dampen(float damp)
     {
-        const float damp = OneHalfToPower(dt/halflife);
         currBallList[ 0].vel *= damp;
         currBallList[ 1].vel *= damp;
         currBallList[ 2].vel *= damp;
@@ -12,9 +12,19 @@ namespace Sapphire
         ElastikaMesh();
         static MeshAudioParameters getAudioParameters();
 
+        static float DampingFactor(float dt, float halflife)
+        {
+            return OneHalfToPower(dt/halflife);
+        }
+
         void Update(float dt, float halflife)
         {
-            Dampen(dt, halflife);
+            Step(dt, DampingFactor(dt, halflife));
+        }
+
+        void Step(float dt, float damp)     // `damp` must be the value returned by DampingFactor(dt, halflife)
+        {
+            Dampen(damp);
             CalcForces(currBallList);
             Extrapolate(dt/2);
             CalcForces(nextBallList);
@@ -23,7 +33,7 @@ namespace Sapphire
         }
 
     private:
-        void Dampen(float dt, float halflife);
+        void Dampen(float damp);
         void CalcForces(const BallList& blist);
         void Extrapolate(float dt);
     };
@@ -0,0 +1,614 @@
+#pragma once
+#include <array>
+#include "elastika_engine.hpp"
+#include "elastika_simd_mesh.hpp"
+
+// Sapphire mesh physics engine, by Don Cross <cosinekitty@gmail.com>
+// https://github.com/cosinekitty/sapphire
+
+namespace Sapphire
+{
+    // PolySimdMesh simulates `nvoices` independent copies of a SimdMesh topology.
+    // Instead of packing x, y, z of a single ball into one SIMD register,
+    // each PhysicsVector holds the same coordinate of the same ball for 4 different voices.
+    // Every voice follows the same sequence of operations as the generated ElastikaMesh code,
+    // so each lane produces exactly the same result as a monophonic mesh would.
+    // Stiffness, rest length, magnetic field, damping, and ball masses are all per-voice.
+
+    template <unsigned nvoices>
+    class PolySimdMesh
+    {
+    public:
+        static_assert(nvoices > 0, "PolySimdMesh must have at least one voice.");
+        static constexpr unsigned ngroups = (nvoices + 3) / 4;      // number of 4-voice SIMD groups
+
+    private:
+        struct State
+        {
+            std::vector<PhysicsVector> x, y, z;         // ball positions [m], indexed by slot*ngroups + group
+            std::vector<PhysicsVector> vx, vy, vz;      // ball velocities [m/s], indexed by slot*ngroups + group
+
+            void resize(std::size_t n)
+            {
+                x.resize(n);
+                y.resize(n);
+                z.resize(n);
+                vx.resize(n);
+                vy.resize(n);
+                vz.resize(n);
+            }
+        };
+
+        struct PolySpring
+        {
+            int a;              // slot index of the first ball
+            int b;              // slot index of the second ball
+            bool aMobile;
+            bool bMobile;
+        };
+
+        std::vector<int> ballSlot;      // maps ball index to slot index
+        const int nslots;
+        const int mobileSlots;
+        State curr;
+        State next;
+        std::vector<PhysicsVector> ox, oy, oz;      // original positions
+        std::vector<PhysicsVector> mass;
+        std::vector<PhysicsVector> fx, fy, fz;
+        std::vector<PolySpring> springs;
+        std::array<PhysicsVector, ngroups> stiffness;
+        std::array<PhysicsVector, ngroups> restLength;
+        std::array<PhysicsVector, ngroups> bx, by, bz;      // magnetic field components
+        std::array<PhysicsVector, ngroups> damp;
+        float speedLimit = MESH_DEFAULT_SPEED_LIMIT;
+
+        static std::size_t group(unsigned voice) { return voice / 4; }
+        static int lane(unsigned voice) { return static_cast<int>(voice % 4); }
+
+        std::size_t index(int s, std::size_t g) const
+        {
+            return static_cast<std::size_t>(s)*ngroups + g;
+        }
+
+        static void ValidateVoice(unsigned voice)
+        {
+            if (voice >= nvoices)
+                throw std::out_of_range("PolySimdMesh voice index");
+        }
+
+        int BallSlot(int ballIndex) const
+        {
+            return ballSlot.at(ballIndex);
+        }
+
+        static PhysicsVector sqrt(const PhysicsVector& a)
+        {
+            return PhysicsVector(_mm_sqrt_ps(a.v));
+        }
+
+        void Dampen()
+        {
+            for (int s = 0; s < mobileSlots; ++s)
+            {
+                for (std::size_t g = 0; g < ngroups; ++g)
+                {
+                    const std::size_t i = index(s, g);
+                    curr.vx[i] *= damp[g];
+                    curr.vy[i] *= damp[g];
+                    curr.vz[i] *= damp[g];
+                }
+            }
+        }
+
+        void CalcForces(const State& st)
+        {
+            // Start with the magnetic force on each mobile ball: F = v x B.
+            for (int s = 0; s < mobileSlots; ++s)
+            {
+                for (std::size_t g = 0; g < ngroups; ++g)
+                {
+                    const std::size_t i = index(s, g);
+                    fx[i] = st.vy[i]*bz[g] - st.vz[i]*by[g];
+                    fy[i] = st.vz[i]*bx[g] - st.vx[i]*bz[g];
+                    fz[i] = st.vx[i]*by[g] - st.vy[i]*bx[g];
+                }
+            }
+
+            // Advance the same spring in every voice at once.
+            // There is no gather or scatter: the topology is the same for all lanes.
+            const PhysicsVector minDist {1.0e-9f};
+            for (const PolySpring& sp : springs)
+            {
+                for (std::size_t g = 0; g < ngroups; ++g)
+                {
+                    const std::size_t ia = index(sp.a, g);
+                    const std::size_t ib = index(sp.b, g);
+                    PhysicsVector dx = st.x[ib] - st.x[ia];
+                    PhysicsVector dy = st.y[ib] - st.y[ia];
+                    PhysicsVector dz = st.z[ib] - st.z[ia];
+                    PhysicsVector dist = sqrt(dx*dx + dy*dy + dz*dz);
+                    PhysicsVector scale = (stiffness[g] * (dist - restLength[g])) / dist;
+                    scale = PhysicsVector(_mm_and_ps(_mm_cmpge_ps(dist.v, minDist.v), scale.v));
+                    PhysicsVector gx = scale * dx;
+                    PhysicsVector gy = scale * dy;
+                    PhysicsVector gz = scale * dz;
+                    if (sp.aMobile)
+                    {
+                        fx[ia] += gx;
+                        fy[ia] += gy;
+                        fz[ia] += gz;
+                    }
+                    if (sp.bMobile)
+                    {
+                        fx[ib] -= gx;
+                        fy[ib] -= gy;
+                        fz[ib] -= gz;
+                    }
+                }
+            }
+        }
+
+        void Extrapolate(float dt)
+        {
+            const PhysicsVector step {dt};
+            const PhysicsVector half {dt/2};
+            const PhysicsVector limit {speedLimit};
+            const PhysicsVector limitSquared {speedLimit * speedLimit};
+            const PhysicsVector one {1.0f};
+            for (int s = 0; s < mobileSlots; ++s)
+            {
+                for (std::size_t g = 0; g < ngroups; ++g)
+                {
+                    const std::size_t i = index(s, g);
+                    PhysicsVector factor = step / mass[i];
+                    PhysicsVector nvx = curr.vx[i] + factor*fx[i];
+                    PhysicsVector nvy = curr.vy[i] + factor*fy[i];
+                    PhysicsVector nvz = curr.vz[i] + factor*fz[i];
+                    PhysicsVector speedSquared = nvx*nvx + nvy*nvy + nvz*nvz;
+                    __m128 over = _mm_cmpgt_ps(speedSquared.v, limitSquared.v);
+                    PhysicsVector brake = limit / sqrt(speedSquared);
+                    brake = PhysicsVector(_mm_or_ps(_mm_and_ps(over, brake.v), _mm_andnot_ps(over, one.v)));
+                    nvx *= brake;
+                    nvy *= brake;
+                    nvz *= brake;
+                    next.vx[i] = nvx;
+                    next.vy[i] = nvy;
+                    next.vz[i] = nvz;
+                    next.x[i] = curr.x[i] + half*(curr.vx[i] + nvx);
+                    next.y[i] = curr.y[i] + half*(curr.vy[i] + nvy);
+                    next.z[i] = curr.z[i] + half*(curr.vz[i] + nvz);
+                }
+            }
+        }
+
+        void SetSlotValue(std::vector<PhysicsVector>& array, int s, unsigned voice, float value)
+        {
+            array[index(s, group(voice))][lane(voice)] = value;
+        }
+
+    public:
+        explicit PolySimdMesh(const SimdMesh& proto)
+            : nslots(proto.NumSlots())
+            , mobileSlots(proto.NumMobileSlots())
+        {
+            for (int b = 0; b < proto.NumBalls(); ++b)
+                ballSlot.push_back(proto.BallSlot(b));
+
+            const std::size_t n = static_cast<std::size_t>(nslots) * ngroups;
+            curr.resize(n);
+            next.resize(n);
+            ox.resize(n);
+            oy.resize(n);
+            oz.resize(n);
+            mass.resize(n);
+            fx.resize(n);
+            fy.resize(n);
+            fz.resize(n);
+
+            for (int s = 0; s < nslots; ++s)
+            {
+                const PhysicsVector origin = proto.SlotOrigin(s);
+                for (std::size_t g = 0; g < ngroups; ++g)
+                {
+                    const std::size_t i = index(s, g);
+                    ox[i] = PhysicsVector(origin[0]);
+                    oy[i] = PhysicsVector(origin[1]);
+                    oz[i] = PhysicsVector(origin[2]);
+                    mass[i] = PhysicsVector(proto.SlotMass(s));
+                }
+            }
+
+            const int nsprings = proto.NumSprings();
+            for (int k = 0; k < nsprings; ++k)
+            {
+                const int a = proto.SpringSlotA(k);
+                const int b = proto.SpringSlotB(k);
+                springs.push_back(PolySpring{a, b, a < mobileSlots, b < mobileSlots});
+            }
+
+            for (std::size_t g = 0; g < ngroups; ++g)
+            {
+                stiffness[g] = PhysicsVector(proto.GetStiffness());
+                restLength[g] = PhysicsVector(proto.GetRestLength());
+                damp[g] = PhysicsVector(1.0f);
+            }
+            speedLimit = proto.GetSpeedLimit();
+
+            Quiet();
+            next = curr;    // anchors in `next` must also start at their original positions
+        }
+
+        void Quiet()
+        {
+            curr.x = ox;
+            curr.y = oy;
+            curr.z = oz;
+            std::fill(curr.vx.begin(), curr.vx.end(), PhysicsVector::zero());
+            std::fill(curr.vy.begin(), curr.vy.end(), PhysicsVector::zero());
+            std::fill(curr.vz.begin(), curr.vz.end(), PhysicsVector::zero());
+        }
+
+        void Quiet(unsigned voice)
+        {
+            ValidateVoice(voice);
+            const std::size_t g = group(voice);
+            const int n = lane(voice);
+            for (int s = 0; s < nslots; ++s)
+            {
+                const std::size_t i = index(s, g);
+                curr.x[i][n] = ox[i][n];
+                curr.y[i][n] = oy[i][n];
+                curr.z[i][n] = oz[i][n];
+                curr.vx[i][n] = curr.vy[i][n] = curr.vz[i][n] = 0.0f;
+            }
+        }
+
+        void SetStiffness(unsigned voice, float k)
+        {
+            ValidateVoice(voice);
+            stiffness[group(voice)][lane(voice)] = std::max(0.0f, k);
+        }
+
+        void SetRestLength(unsigned voice, float r)
+        {
+            ValidateVoice(voice);
+            restLength[group(voice)][lane(voice)] = std::max(0.0f, r);
+        }
+
+        void SetMagneticField(unsigned voice, const PhysicsVector& magnet)
+        {
+            ValidateVoice(voice);
+            bx[group(voice)][lane(voice)] = magnet[0];
+            by[group(voice)][lane(voice)] = magnet[1];
+            bz[group(voice)][lane(voice)] = magnet[2];
+        }
+
+        void SetDampingFactor(unsigned voice, float factor)    // the value returned by SimdMesh::DampingFactor
+        {
+            ValidateVoice(voice);
+            damp[group(voice)][lane(voice)] = factor;
+        }
+
+        void SetBallMass(unsigned voice, int ballIndex, float m)
+        {
+            ValidateVoice(voice);
+            const int s = BallSlot(ballIndex);
+            if ((s < mobileSlots) != (m > 0.0f))
+                throw std::logic_error("PolySimdMesh cannot convert between mobile balls and anchors.");
+            SetSlotValue(mass, s, voice, m);
+        }
+
+        PhysicsVector GetBallOrigin(unsigned voice, int ballIndex) const
+        {
+            ValidateVoice(voice);
+            const std::size_t i = index(BallSlot(ballIndex), group(voice));
+            const int n = lane(voice);
+            return PhysicsVector(ox[i][n], oy[i][n], oz[i][n], 0.0f);
+        }
+
+        PhysicsVector GetBallDisplacement(unsigned voice, int ballIndex) const
+        {
+            ValidateVoice(voice);
+            const std::size_t i = index(BallSlot(ballIndex), group(voice));
+            const int n = lane(voice);
+            return PhysicsVector(curr.x[i][n] - ox[i][n], curr.y[i][n] - oy[i][n], curr.z[i][n] - oz[i][n], 0.0f);
+        }
+
+        void SetBallPosition(unsigned voice, int ballIndex, const PhysicsVector& pos)
+        {
+            ValidateVoice(voice);
+            const int s = BallSlot(ballIndex);
+            SetSlotValue(curr.x, s, voice, pos[0]);
+            SetSlotValue(curr.y, s, voice, pos[1]);
+            SetSlotValue(curr.z, s, voice, pos[2]);
+            SetSlotValue(next.x, s, voice, pos[0]);
+            SetSlotValue(next.y, s, voice, pos[1]);
+            SetSlotValue(next.z, s, voice, pos[2]);
+        }
+
+        void Step(float dt)
+        {
+            Dampen();
+            CalcForces(curr);
+            Extrapolate(dt/2);
+            CalcForces(next);
+            Extrapolate(dt);
+            std::swap(next, curr);
+        }
+    };
+
+
+    // PolyElastikaEngine runs `nvoices` independent Elastika voices in lockstep.
+    // Each voice produces the same output as a separate ElastikaEngine with the same settings,
+    // but the mesh update for 4 voices happens in each SIMD instruction.
+
+    template <unsigned nvoices>
+    class PolyElastikaEngine
+    {
+    private:
+        using filter_t = StagedFilter<PhysicsVector, ELASTIKA_FILTER_LAYERS>;
+        static constexpr unsigned ngroups = PolySimdMesh<nvoices>::ngroups;
+
+        struct Voice
+        {
+            float halfLife = 0;
+            float damp = 0;
+            float drive = 0;
+            float gain = 0;
+            float mix = 0;
+            float inTilt = -1;
+            float outTilt = -1;
+            PhysicsVector leftInputDir;
+            PhysicsVector rightInputDir;
+            PhysicsVector leftOutputDir;
+            PhysicsVector rightOutputDir;
+            AutomaticGainLimiter agc;
+        };
+
+        const MeshAudioParameters mp;
+        PolySimdMesh<nvoices> mesh;
+        std::array<Voice, nvoices> voices;
+        std::array<filter_t, ngroups> leftLoCut;
+        std::array<filter_t, ngroups> rightLoCut;
+        float cachedDt = 0;
+        int outputVerifyCounter = 0;
+        bool enableAgc = false;
+
+        static void ValidateVoice(unsigned voice)
+        {
+            if (voice >= nvoices)
+                throw std::out_of_range("PolyElastikaEngine voice index");
+        }
+
+        void updateDamping(unsigned v)
+        {
+            voices[v].damp = SimdMesh::DampingFactor(cachedDt, voices[v].halfLife);
+            mesh.SetDampingFactor(v, voices[v].damp);
+        }
+
+    public:
+        PolyElastikaEngine()
+            : mp(ElastikaSimdMesh::getAudioParameters())
+            , mesh(ElastikaSimdMesh())
+        {
+            initialize();
+        }
+
+        static constexpr unsigned voiceCount() { return nvoices; }
+
+        void initialize()
+        {
+            outputVerifyCounter = 0;
+            setDcRejectFrequency(20);
+            for (unsigned v = 0; v < nvoices; ++v)
+            {
+                setFriction(v);
+                setSpan(v);
+                setStiffness(v);
+                setCurl(v);
+                setMass(v);
+                setDrive(v);
+                setGain(v);
+                setInputTilt(v);
+                setOutputTilt(v);
+                setMix(v);
+            }
+            setAgcEnabled(true);
+            quiet();
+        }
+
+        void setDcRejectFrequency(float frequency)
+        {
+            for (unsigned g = 0; g < ngroups; ++g)
+            {
+                leftLoCut[g].SetCutoffFrequency(frequency);
+                rightLoCut[g].SetCutoffFrequency(frequency);
+            }
+        }
+
+        void quiet()
+        {
+            mesh.Quiet();
+            for (unsigned g = 0; g < ngroups; ++g)
+            {
+                leftLoCut[g].Reset();
+                rightLoCut[g].Reset();
+            }
+            for (Voice& voice : voices)
+                voice.agc.initialize();
+        }
+
+        void quiet(unsigned v)
+        {
+            // Reset a single voice without disturbing the others.
+            ValidateVoice(v);
+            mesh.Quiet(v);
+            // Each DC reject filter handles 4 voices, one per lane.
+            leftLoCut[v/4].ResetLane(v%4);
+            rightLoCut[v/4].ResetLane(v%4);
+            voices[v].agc.initialize();
+        }
+
+        void setFriction(unsigned v, float slider = 0.5f)
+        {
+            ValidateVoice(v);
+            const float halfLife = ElastikaHalfLife(slider);
+            if (halfLife != voices[v].halfLife)
+            {
+                voices[v].halfLife = halfLife;
+                if (cachedDt > 0)
+                    updateDamping(v);
+            }
+        }
+
+        void setSpan(unsigned v, float slider = 0.5f)
+        {
+            mesh.SetRestLength(v, ElastikaRestLength(slider));
+        }
+
+        void setStiffness(unsigned v, float slider = 0.5f)
+        {
+            mesh.SetStiffness(v, ElastikaStiffness(slider));
+        }
+
+        void setCurl(unsigned v, float slider = 0.0f)
+        {
+            mesh.SetMagneticField(v, ElastikaMagneticField(slider));
+        }
+
+        void setMass(unsigned v, float slider = 0.0f)
+        {
+            const float mass = ElastikaBallMass(slider);
+            mesh.SetBallMass(v, mp.leftVarMassBallIndex, mass);
+            mesh.SetBallMass(v, mp.rightVarMassBallIndex, mass);
+        }
+
+        void setDrive(unsigned v, float slider = 1.0f)
+        {
+            ValidateVoice(v);
+            voices[v].drive = ElastikaLevel(slider);
+        }
+
+        void setGain(unsigned v, float slider = 1.0f)
+        {
+            ValidateVoice(v);
+            voices[v].gain = ElastikaLevel(slider);
+        }
+
+        void setInputTilt(unsigned v, float slider = 0.5f)
+        {
+            ValidateVoice(v);
+            Voice& voice = voices[v];
+            float tilt = std::clamp(slider, 0.0f, 1.0f);
+            if (tilt != voice.inTilt)
+            {
+                voice.inTilt = tilt;
+                voice.leftInputDir  = Interpolate(tilt, mp.leftInputDir1,  mp.leftInputDir2);
+                voice.rightInputDir = Interpolate(tilt, mp.rightInputDir1, mp.rightInputDir2);
+            }
+        }
+
+        void setOutputTilt(unsigned v, float slider = 0.5f)
+        {
+            ValidateVoice(v);
+            Voice& voice = voices[v];
+            float tilt = std::clamp(slider, 0.0f, 1.0f);
+            if (tilt != voice.outTilt)
+            {
+                voice.outTilt = tilt;
+                voice.leftOutputDir  = Interpolate(tilt, mp.leftOutputDir1,  mp.leftOutputDir2);
+                voice.rightOutputDir = Interpolate(tilt, mp.rightOutputDir1, mp.rightOutputDir2);
+            }
+        }
+
+        void setMix(unsigned v, float slider = 1.0f)
+        {
+            ValidateVoice(v);
+            voices[v].mix = std::clamp(slider, 0.0f, 1.0f);
+        }
+
+        bool getAgcEnabled() const { return enableAgc; }
+
+        void setAgcEnabled(bool enable)
+        {
+            if (enable && !enableAgc)
+                for (Voice& voice : voices)
+                    voice.agc.initialize();
+            enableAgc = enable;
+        }
+
+        void setAgcLevel(float level)
+        {
+            const float ceiling = level / 5.0f;
+            for (Voice& voice : voices)
+                voice.agc.setCeiling(ceiling);
+        }
+
+        // Process one stereo frame for every voice.
+        // Each array must have `nvoices` elements.
+        // Returns false if any voice had to be reset because of non-finite output.
+        bool process(float sampleRate, const float leftIn[], const float rightIn[], float leftOut[], float rightOut[])
+        {
+            const float dt = 1/sampleRate;
+            if (dt != cachedDt)
+            {
+                cachedDt = dt;
+                for (unsigned v = 0; v < nvoices; ++v)
+                    updateDamping(v);
+            }
+
+            // Feed audio stimulus into the mesh.
+            for (unsigned v = 0; v < nvoices; ++v)
+            {
+                const Voice& voice = voices[v];
+                mesh.SetBallPosition(v, mp.leftInputBallIndex, mesh.GetBallOrigin(v, mp.leftInputBallIndex) + ((voice.drive * leftIn[v]) * voice.leftInputDir));
+                mesh.SetBallPosition(v, mp.rightInputBallIndex, mesh.GetBallOrigin(v, mp.rightInputBallIndex) + ((voice.drive * rightIn[v]) * voice.rightInputDir));
+            }
+
+            // Update all voices by one sample's worth of time.
+            mesh.Step(dt);
+
+            // Extract output and reject DC, 4 voices at a time.
+            for (unsigned g = 0; g < ngroups; ++g)
+            {
+                PhysicsVector left, right;
+                for (unsigned n = 0; n < 4 && 4*g + n < nvoices; ++n)
+                {
+                    const unsigned v = 4*g + n;
+                    left[n]  = Dot(mesh.GetBallDisplacement(v, mp.leftOutputBallIndex),  voices[v].leftOutputDir);
+                    right[n] = Dot(mesh.GetBallDisplacement(v, mp.rightOutputBallIndex), voices[v].rightOutputDir);
+                }
+                left  = leftLoCut[g].UpdateHiPass(left, sampleRate);
+                right = rightLoCut[g].UpdateHiPass(right, sampleRate);
+                for (unsigned n = 0; n < 4 && 4*g + n < nvoices; ++n)
+                {
+                    const unsigned v = 4*g + n;
+                    leftOut[v]  = CubicMix(voices[v].mix, leftIn[v],  voices[v].gain * left[n]);
+                    rightOut[v] = CubicMix(voices[v].mix, rightIn[v], voices[v].gain * right[n]);
+                }
+            }
+
+            if (enableAgc)
+                for (unsigned v = 0; v < nvoices; ++v)
+                    voices[v].agc.process(sampleRate, leftOut[v], rightOut[v]);
+
+            // Periodically check for non-finite output, the same way ElastikaEngine does.
+            // Only the voices with a problem are reset.
+            bool ok = true;
+            if (++outputVerifyCounter >= 11000)
+            {
+                outputVerifyCounter = 0;
+                for (unsigned v = 0; v < nvoices; ++v)
+                {
+                    if (!std::isfinite(leftOut[v]) || !std::isfinite(rightOut[v]))
+                    {
+                        quiet(v);
+                        leftOut[v] = rightOut[v] = 0;
+                        ok = false;
+                    }
+                }
+            }
+            return ok;
+        }
+    };
+}
@@ -0,0 +1,105 @@
+//****  GENERATED CODE  ****  DO NOT EDIT  *****
+
+#include "elastika_simd_mesh.hpp"
+
+namespace Sapphire
+{
+    ElastikaSimdMesh::ElastikaSimdMesh()
+        : SimdMesh(34, 22)
+    {
+        AddBall(  1e-06,   0.001,              0, 0);   //  0
+        AddBall(  1e-06,  0.0005,   0.0008660255, 0);   //  1
+        AddBall(  1e-06, -0.0005,   0.0008660255, 0);   //  2
+        AddBall(  1e-06,  -0.001,              0, 0);   //  3
+        AddBall(  1e-06, -0.0005,  -0.0008660255, 0);   //  4
+        AddBall(  1e-06,  0.0005,  -0.0008660255, 0);   //  5
+        AddBall(  1e-06,  0.0025,   0.0008660255, 0);   //  6
+        AddBall(  1e-06,   0.002,    0.001732051, 0);   //  7
+        AddBall(  1e-06,   0.001,    0.001732051, 0);   //  8
+        AddBall(  1e-06,   0.002,              0, 0);   //  9
+        AddBall(  1e-06,   0.004,    0.001732051, 0);   // 10
+        AddBall(  1e-06,  0.0035,    0.002598076, 0);   // 11
+        AddBall(  1e-06,  0.0025,    0.002598076, 0);   // 12
+        AddBall(  1e-06,  0.0035,   0.0008660255, 0);   // 13
+        AddBall(  1e-06,   0.001,   -0.001732051, 0);   // 14
+        AddBall(  1e-06,  -0.001,   -0.001732051, 0);   // 15
+        AddBall(  1e-06, -0.0005,   -0.002598076, 0);   // 16
+        AddBall(  1e-06,  0.0005,   -0.002598076, 0);   // 17
+        AddBall(  1e-06,  0.0025,  -0.0008660255, 0);   // 18
+        AddBall(  1e-06,   0.002,   -0.001732051, 0);   // 19
+        AddBall(  1e-06,   0.004,              0, 0);   // 20
+        AddBall(  1e-06,  0.0035,  -0.0008660255, 0);   // 21
+        AddBall(     -1,  -0.002,              0, 0);   // 22
+        AddBall(     -1,  -0.001,    0.001732051, 0);   // 23
+        AddBall(     -1,  -0.002,   -0.001732051, 0);   // 24
+        AddBall(     -1,  0.0005,    0.002598076, 0);   // 25
+        AddBall(     -1,  -0.001,   -0.003464102, 0);   // 26
+        AddBall(     -1,   0.002,    0.003464102, 0);   // 27
+        AddBall(     -1,   0.001,   -0.003464102, 0);   // 28
+        AddBall(     -1,   0.004,    0.003464102, 0);   // 29
+        AddBall(     -1,  0.0025,   -0.002598076, 0);   // 30
+        AddBall(     -1,   0.005,    0.001732051, 0);   // 31
+        AddBall(     -1,   0.004,   -0.001732051, 0);   // 32
+        AddBall(     -1,   0.005,              0, 0);   // 33
+
+        AddSpring( 3,  2);
+        AddSpring( 3, 22);
+        AddSpring( 3,  4);
+        AddSpring( 2,  1);
+        AddSpring( 2, 23);
+        AddSpring(15,  4);
+        AddSpring(15, 24);
+        AddSpring(15, 16);
+        AddSpring( 4,  5);
+        AddSpring( 1,  8);
+        AddSpring( 1,  0);
+        AddSpring( 8,  7);
+        AddSpring( 8, 25);
+        AddSpring(16, 17);
+        AddSpring(16, 26);
+        AddSpring( 5,  0);
+        AddSpring( 5, 14);
+        AddSpring( 0,  9);
+        AddSpring( 7, 12);
+        AddSpring( 7,  6);
+        AddSpring(12, 11);
+        AddSpring(12, 27);
+        AddSpring(17, 14);
+        AddSpring(17, 28);
+        AddSpring(14, 19);
+        AddSpring( 9,  6);
+        AddSpring( 9, 18);
+        AddSpring( 6, 13);
+        AddSpring(11, 29);
+        AddSpring(11, 10);
+        AddSpring(19, 18);
+        AddSpring(19, 30);
+        AddSpring(18, 21);
+        AddSpring(13, 10);
+        AddSpring(13, 20);
+        AddSpring(10, 31);
+        AddSpring(21, 20);
+        AddSpring(21, 32);
+        AddSpring(20, 33);
+    }
+
+    MeshAudioParameters ElastikaSimdMesh::getAudioParameters()
+    {
+        MeshAudioParameters mp;
+        mp.leftInputBallIndex = 23;
+        mp.rightInputBallIndex = 32;
+        mp.leftOutputBallIndex = 12;
+        mp.rightOutputBallIndex = 17;
+        mp.leftVarMassBallIndex = 6;
+        mp.rightVarMassBallIndex = 5;
+        mp.leftInputDir1 = PhysicsVector{0, 0, 0.0001, 0};
+        mp.leftInputDir2 = PhysicsVector{7e-05, -7e-05, 0, 0};
+        mp.rightInputDir1 = PhysicsVector{0, 0, 0.0001, 0};
+        mp.rightInputDir2 = PhysicsVector{-7e-05, 7e-05, 0, 0};
+        mp.leftOutputDir1 = PhysicsVector{0, 0, 6000, 0};
+        mp.leftOutputDir2 = PhysicsVector{0, -6000, 0, 0};
+        mp.rightOutputDir1 = PhysicsVector{0, 0, 6000, 0};
+        mp.rightOutputDir2 = PhysicsVector{0, 6000, 0, 0};
+        return mp;
+    }
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include "mesh_simd.hpp"
+
+namespace Sapphire
+{
+    // ElastikaSimdMesh has the same topology as ElastikaMesh,
+    // in the slot layout that PolyElastikaEngine simulates.
+
+    class ElastikaSimdMesh : public SimdMesh
+    {
+    public:
+        ElastikaSimdMesh();
+        static MeshAudioParameters getAudioParameters();
+    };
+}
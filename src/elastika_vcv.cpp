@@ -80,7 +80,12 @@ namespace Sapphire
         using in_frame_t   = Resampler::Frame<InChannelCount>;
         using out_frame_t  = Resampler::Frame<OutChannelCount>;
         using model_base_t = Resampler::InternalModel<InChannelCount, OutChannelCount>;
-        using hamburger_t  = Resampler::Hamburger<InChannelCount, OutChannelCount, QueueMaxFrameCount>;
+        using hamburger_t  = Resampler::Hamburger<
+            InChannelCount,
+            OutChannelCount,
+            QueueMaxFrameCount,
+            dsp::SampleRateConverter<InChannelCount>,
+            dsp::SampleRateConverter<OutChannelCount>>;
 
 
         class ElastikaModel : public model_base_t
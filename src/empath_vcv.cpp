@@ -6,6 +6,7 @@
 #include "sapphire_widget.hpp"
 #include "sapphire_crossfader.hpp"
 #include "sapphire_smoother.hpp"
+#include "sapphire_control_rate.hpp"
 #include "cascade_filter.hpp"
 #include "chaos_fountain.hpp"
 
@@ -20,6 +21,7 @@ namespace Sapphire
         constexpr int DEFAULT_FILTER_STAGES = 1;
 
         using filter_t = CascadeFilter<MAX_FILTER_STAGES>;
+        using filter_bank_t = CascadeFilterBank<MAX_FILTER_STAGES, PORT_MAX_CHANNELS>;
 
         struct Frame
         {
@@ -51,6 +53,31 @@ namespace Sapphire
             Polyphonic = 1,     // each channel gets its own spectrum graph
         };
 
+        enum class ChaosSharing
+        {
+            PerModule,      // every module in the chain runs its own chaos fountain
+            Shared,         // the input module runs one larger fountain for the whole chain
+            LEN,
+            Default = PerModule
+        };
+
+        // With shared chaos, the input module's fountain has a slot of signals for each
+        // module to its right, indexed by chain position. Modules past the last slot
+        // run their own fountains, so no two modules ever get the same signals.
+        // Signals are shuffled only within a slot, so the fountain integrates
+        // just the slots the chain uses.
+        constexpr unsigned SharedChaosSlots = 16;
+        constexpr unsigned SharedChaosSlotSignals = 7;
+        constexpr unsigned nSharedChaoticSignals = SharedChaosSlots * SharedChaosSlotSignals;
+        using shared_fountain_t = ChaosFountain<nSharedChaoticSignals, std::mt19937_64, SharedChaosSlotSignals>;
+
+        constexpr uint64_t SharedChaosSeed(uint64_t seed)
+        {
+            // Derive the shared fountain's seed from the input module's own seed,
+            // so randomize/undo and saved patches need no extra state.
+            return seed ^ 0x436861696e536565;     // ASCII "ChainSee"
+        }
+
         struct ChaosFountainInfo
         {
             double dt{};              // time increment in seconds, calculated from speed knob
@@ -59,6 +86,9 @@ namespace Sapphire
             float antiClick{};        // 1 most of the time, but ramps down to 0 before, and back up to 1 after changing all chaotic seeds
             bool  reset{};            // set to true only on the specific process() call where all chaos fountains should pick a new random 64-bit chaos seed and regenerate from that new starting position.
             bool  frozen{};           // when true, completely turns off all chaos fountains to reduce CPU usage
+            bool  shared{};           // when true, modules index into `sharedBatch` instead of running their own fountains
+            ControlRate controlRate = ControlRate::Default;     // how often fountains are updated between interpolated samples
+            shared_fountain_t::batch_t sharedBatch;
         };
 
         struct ForwardMessage
@@ -74,13 +104,61 @@ namespace Sapphire
             Frame soloAudio;        // the sum of all output audio for taps with solo enabled
             SpectrumDisplayMode spectrumDisplayMode = SpectrumDisplayMode::Monophonic;
             InterpolatorKind interpolatorKind = InterpolatorKind::Default;
+            FilterTanMode tanMode = FilterTanMode::Default;
             ChaosFountainInfo chaos;
         };
 
+        template <typename fountain_t>
+        using ChaosControl = ControlRateInterpolator<std::tuple_size<decltype(fountain_t::batch_t::signal)>::value>;
+
+        template <typename fountain_t>
+        typename fountain_t::batch_t RunChaos(
+            fountain_t& fountain,
+            ChaosControl<fountain_t>& control,
+            const ChaosFountainInfo& chaos,
+            unsigned nused = std::tuple_size<decltype(fountain_t::batch_t::signal)>::value)
+        {
+            // Update the fountain once per control interval, covering that many samples,
+            // and interpolate its output back to audio rate.
+            // Signals at or beyond `nused` may hold still, because nobody reads them.
+            control.setInterval(ControlRateInterval(chaos.controlRate));
+            if (chaos.reset)
+                control.initialize();   // the chain is silent, and the fountain may have jumped to a new seed
+
+            if (control.isDue())
+            {
+                if (!chaos.frozen)
+                    fountain.update(chaos.dt * control.getInterval(), nused);
+                control.push(fountain.getBatch(chaos.levelKnob).signal);
+            }
+
+            typename fountain_t::batch_t batch;
+            batch.signal = control.process();
+            return batch;
+        }
+
+        template <typename fountain_t>
+        typename fountain_t::batch_t UpdateChaos(fountain_t& fountain, ChaosControl<fountain_t>& control, const ForwardMessage& message)
+        {
+            using batch_t = typename fountain_t::batch_t;
+            constexpr unsigned nsignals = std::tuple_size<decltype(batch_t::signal)>::value;
+            static_assert(nsignals <= SharedChaosSlotSignals);
+
+            if (!message.chaos.shared || message.chainIndex <= 0 || message.chainIndex > static_cast<int>(SharedChaosSlots))
+                return RunChaos(fountain, control, message.chaos);
+
+            batch_t batch;
+            const unsigned slot = static_cast<unsigned>(message.chainIndex - 1);
+            for (unsigned i = 0; i < nsignals; ++i)
+                batch.signal[i] = message.chaos.sharedBatch.signal[slot*SharedChaosSlotSignals + i];
+            return batch;
+        }
+
         struct BackwardMessage
         {
             bool valid = false;
             int soloCount = 0;      // the correct solo count, being reported back from the end of the chain
+            int chainLength = 0;    // how many modules to the right of the input module, reported back from the end of the chain
             float spectrumPowerScale = 1;
         };
 
@@ -765,9 +843,16 @@ namespace Sapphire
                 bool autoCreateExpanders = true;
                 PortLabelMode inputLabels = PortLabelMode::Stereo;
                 fountain_t fountain{rack::random::u64()};
+                shared_fountain_t sharedFountain{SharedChaosSeed(fountain.getSeed())};
+                ChaosControl<fountain_t> chaosControl;
+                ChaosControl<shared_fountain_t> sharedChaosControl;
+                ControlRate chaosControlRate = ControlRate::Default;
+                ChaosSharing chaosSharing = ChaosSharing::Default;          // what the user selected
+                ChaosSharing activeChaosSharing = ChaosSharing::Default;    // switches only while the chain is silent
                 Crossfader chaosStereoCrossfader;
                 float speedChaos{};
                 InterpolatorKind interpolatorKind = InterpolatorKind::Default;
+                FilterTanMode tanMode = FilterTanMode::Default;
                 Smoother chaosAntiClickSmoother{0.025};
 
                 explicit InputModule()
@@ -796,13 +881,23 @@ namespace Sapphire
                     chaosStereoCrossfader.snapToFront();
                     speedChaos = 0;
                     chaosAntiClickSmoother.initialize();
+                    chaosSharing = activeChaosSharing = ChaosSharing::Default;
+                    chaosControlRate = ControlRate::Default;
+                    chaosControl.initialize();
+                    sharedChaosControl.initialize();
                 }
 
                 void onReset(const ResetEvent& e) override
                 {
                     EmpathModule::onReset(e);
                     InputModule_initialize();
-                    fountain.reset();
+                    resetChaos(fountain.getSeed());
+                }
+
+                void resetChaos(uint64_t seed)
+                {
+                    fountain.reset(seed);
+                    sharedFountain.reset(SharedChaosSeed(fountain.getSeed()));
                 }
 
                 json_t* dataToJson() override
@@ -810,6 +905,9 @@ namespace Sapphire
                     json_t* root = EmpathModule::dataToJson();
                     jsonSetBool(root, "autoCreateExpanders", autoCreateExpanders);
                     jsonSetEnum(root, "interpolatorKind", interpolatorKind);
+                    jsonSetEnum(root, "tanMode", tanMode);
+                    jsonSetEnum(root, "chaosSharing", chaosSharing);
+                    jsonSetEnum(root, "chaosControlRate", chaosControlRate);
                     jsonSaveSeed(root, "chaosFountainSeed", fountain.getSeed());
                     return root;
                 }
@@ -819,8 +917,12 @@ namespace Sapphire
                     EmpathModule::dataFromJson(root);
                     jsonLoadBool(root, "autoCreateExpanders", autoCreateExpanders);
                     jsonLoadEnum(root, "interpolatorKind", interpolatorKind);
+                    jsonLoadEnum(root, "tanMode", tanMode);
+                    jsonLoadEnum(root, "chaosSharing", chaosSharing);
+                    activeChaosSharing = chaosSharing;
+                    jsonLoadEnum(root, "chaosControlRate", chaosControlRate);
                     if (uint64_t seed = jsonLoadOrGenerateSeed(root, "chaosFountainSeed"))
-                        fountain.reset(seed);
+                        resetChaos(seed);
                 }
 
                 bool polyphonicMode()
@@ -893,24 +995,43 @@ namespace Sapphire
                     outMessage.wetAudio.nchannels = outMessage.dryAudio.nchannels;
                     outMessage.spectrumDisplayMode = getSpectrumDisplayMode();
                     outMessage.interpolatorKind = interpolatorKind;
+                    outMessage.tanMode = tanMode;
                     outMessage.chaos.dt = SimulationTimeIncrement(args.sampleRate, speedKnob);
                     outMessage.chaos.levelKnob = Cube(getControlValueVoltPerOctave(CHAOS_LEVEL_PARAM, CHAOS_LEVEL_ATTEN, CHAOS_LEVEL_CV_INPUT, 0, 2));
                     outMessage.chaos.stereoCrossfade = updateStereoCrossfade(args.sampleRate);
                     outMessage.chaos.frozen = isChaosLevelZero || isChaosFreezeButtonPressed;
+                    outMessage.chaos.controlRate = chaosControlRate;
+
+                    // Changing where the chaos comes from makes the CV jump,
+                    // so fade the whole chain out and back in around the switch.
+                    if (chaosSharing != activeChaosSharing)
+                        chaosAntiClickSmoother.begin();
+
                     outMessage.chaos.antiClick = chaosAntiClickSmoother.process(args.sampleRate);
                     outMessage.dryAudio.multiply(outMessage.chaos.antiClick);
 
                     outMessage.chaos.reset = chaosAntiClickSmoother.isDelayedActionReady();
-                    if (outMessage.chaos.reset && seedToRestore)
+                    if (outMessage.chaos.reset)
                     {
-                        fountain.reset(seedToRestore);
-                        seedToRestore = 0;
+                        activeChaosSharing = chaosSharing;
+                        if (seedToRestore)
+                        {
+                            resetChaos(seedToRestore);
+                            seedToRestore = 0;
+                        }
                     }
 
-                    if (!outMessage.chaos.frozen)
-                        fountain.update(outMessage.chaos.dt);
+                    const batch_t batch = RunChaos(fountain, chaosControl, outMessage.chaos);
 
-                    const batch_t batch = fountain.getBatch(outMessage.chaos.levelKnob);
+                    outMessage.chaos.shared = (activeChaosSharing == ChaosSharing::Shared);
+                    if (outMessage.chaos.shared)
+                    {
+                        // One integration here replaces one per module in the chain,
+                        // covering only the slots that modules currently in the chain use.
+                        const unsigned chainLength = static_cast<unsigned>(receiveBackwardMessageOrDefault().chainLength);
+                        const unsigned nslots = std::min(chainLength, SharedChaosSlots);
+                        outMessage.chaos.sharedBatch = RunChaos(sharedFountain, sharedChaosControl, outMessage.chaos, nslots * SharedChaosSlotSignals);
+                    }
 
                     const float cascadeChaosL = batch.signal.at(0);
                     const float cascadeChaosR = batch.signal.at(1);
@@ -1111,6 +1232,35 @@ namespace Sapphire
                             "change interpolator",
                             inputModule->interpolatorKind
                         ));
+                        menu->addChild(CreateChangeEnumMenuItem(
+                            "Filter tuning",
+                            {
+                                "Exact",
+                                "Fast (uses less CPU with frequency modulation)"
+                            },
+                            "change filter tuning",
+                            inputModule->tanMode
+                        ));
+                        menu->addChild(CreateChangeEnumMenuItem(
+                            "Chaos generators",
+                            {
+                                "One per module",
+                                "Shared by the first 16 modules, seeded by this one (uses less CPU)"
+                            },
+                            "change chaos generators",
+                            inputModule->chaosSharing
+                        ));
+                        menu->addChild(CreateChangeEnumMenuItem(
+                            "Chaos control rate",
+                            {
+                                "Every sample",
+                                "Every 4 samples (uses less CPU)",
+                                "Every 16 samples (uses less CPU)",
+                                "Every 32 samples (uses least CPU)"
+                            },
+                            "change chaos control rate",
+                            inputModule->chaosControlRate
+                        ));
                     }
                 }
 
@@ -1215,16 +1365,6 @@ namespace Sapphire
                 LIGHTS_LEN
             };
 
-            struct ChannelInfo
-            {
-                filter_t filter;
-
-                void initialize()
-                {
-                    filter.initialize();
-                }
-            };
-
             enum class FilterMode
             {
                 Bandpass,
@@ -1469,12 +1609,13 @@ namespace Sapphire
 
             struct FilterModule : EmpathModule
             {
-                ChannelInfo channel[PORT_MAX_CHANNELS];
+                filter_bank_t filterBank;   // the filters for all channels, processed 4 at a time
                 Crossfader modeFader;       // front=bandpass, back=notch
                 Crossfader muteFader;       // front=normal,   back=muted
                 Crossfader soloFader;       // front=normal,   back=solo
                 int totalSoloCount = 0;     // the total number of solo-enabled filters in this chain
                 fountain_t fountain{rack::random::u64()};
+                ChaosControl<fountain_t> chaosControl;
                 SpectrumWidget* spectrum{};
 
                 explicit FilterModule()
@@ -1518,6 +1659,7 @@ namespace Sapphire
                     muteFader.snapToFront();
                     soloFader.snapToFront();
                     totalSoloCount = 0;
+                    chaosControl.initialize();
                     if (spectrum)
                         spectrum->initialize();
                 }
@@ -1533,8 +1675,7 @@ namespace Sapphire
                 void clearAudio()
                 {
                     envelopeFollower.initialize();
-                    for (int c = 0; c < PORT_MAX_CHANNELS; ++c)
-                        channel[c].initialize();
+                    filterBank.initialize();
                 }
 
                 bool isBadOutput(const Frame& frame) const
@@ -1684,10 +1825,7 @@ namespace Sapphire
                         seedToRestore = 0;
                     }
 
-                    if (!inMessage.chaos.frozen)
-                        fountain.update(inMessage.chaos.dt);
-
-                    const batch_t batch = fountain.getBatch(inMessage.chaos.levelKnob);
+                    const batch_t batch = UpdateChaos(fountain, chaosControl, inMessage);
 
                     const float freqChaosL  = batch.signal.at(0);
                     const float freqChaosR  = batch.signal.at(1);
@@ -1722,16 +1860,19 @@ namespace Sapphire
                         float cvRes = 0;
                         float cvLevel = 0;
 
-                        for (int c = 0; c < nc; ++c)
+                        if (limiterRecoveryCountdown > 0)
                         {
-                            auto& q = channel[c];
-                            if (limiterRecoveryCountdown > 0)
+                            for (int c = 0; c < nc; ++c)
                             {
                                 sendFrame.sample[c] = 0;
                                 returnFrame.sample[c] = 0;
                                 levelFrame.sample[c] = 0;
                             }
-                            else
+                        }
+                        else
+                        {
+                            std::array<float, PORT_MAX_CHANNELS> levelKnob{};
+                            for (int c = 0; c < nc; ++c)
                             {
                                 float freqChaos  = ChaosControlVoltage(c, inMessage.chaos.stereoCrossfade, freqChaosL,  freqChaosR);
                                 float resChaos   = ChaosControlVoltage(c, inMessage.chaos.stereoCrossfade, resChaosL,   resChaosR);
@@ -1743,18 +1884,26 @@ namespace Sapphire
 
                                 float freqKnob  = cvGetVoltPerOctave(FREQ_PARAM, FREQ_ATTEN, cvFreq, -OctaveRange, +OctaveRange);
                                 float resKnob   = cvGetControlValue(RES_PARAM, RES_ATTEN, cvRes);
-                                float levelKnob = cvGetControlValue(LEVEL_PARAM, LEVEL_ATTEN, cvLevel, 0, 1);
+                                levelKnob[c]    = cvGetControlValue(LEVEL_PARAM, LEVEL_ATTEN, cvLevel, 0, 1);
 
-                                q.filter.setFrequency(freqKnob);
-                                q.filter.setResonance(resKnob);
-                                q.filter.setInterpolator(inMessage.interpolatorKind);
+                                filterBank.setFrequency(c, freqKnob);
+                                filterBank.setResonance(c, resKnob);
+                            }
 
-                                sendFrame.sample[c] = inMessage.chaos.antiClick * q.filter.process(
-                                    args.sampleRate,
-                                    inMessage.dryAudio.sample[c],
-                                    inMessage.cascade.sample[c],
-                                    modeMix
-                                );
+                            filterBank.setInterpolator(inMessage.interpolatorKind);
+                            filterBank.setTanMode(inMessage.tanMode);
+                            filterBank.process(
+                                args.sampleRate,
+                                nc,
+                                inMessage.dryAudio.sample.data(),
+                                inMessage.cascade.sample.data(),
+                                modeMix,
+                                sendFrame.sample.data()
+                            );
+
+                            for (int c = 0; c < nc; ++c)
+                            {
+                                sendFrame.sample[c] *= inMessage.chaos.antiClick;
 
                                 returnFrame.sample[c] = readSample(
                                     sendFrame.sample[c],
@@ -1765,14 +1914,15 @@ namespace Sapphire
 
                                 levelFrame.sample[c] =
                                     inMessage.chaos.antiClick *
-                                    levelKnob *
+                                    levelKnob[c] *
                                     muteFactor *
                                     returnFrame.sample[c];
                             }
+                        }
 
-                            if (spectrum)
+                        if (spectrum)
+                            for (int c = 0; c < nc; ++c)
                                 spectrum->fftDelayLines[c].write(sendFrame.sample[c]);
-                        }
 
                         Frame outputFrame = panFrame(levelFrame, panChaos);
 
@@ -1821,6 +1971,7 @@ namespace Sapphire
                         // This module is the rightmost of the expander chain currently.
                         // Therefore, we become the source-of-truth for all backward-traveling information.
                         outBackMessage.soloCount = outMessage.soloCount;
+                        outBackMessage.chainLength = std::max(0, inMessage.chainIndex);
                     }
 
                     sendMessage(outMessage);
@@ -2160,6 +2311,7 @@ namespace Sapphire
             {
                 Crossfader firstSoloFader;      // crossfades the treansition between muting everyone else or not
                 fountain_t fountain{rack::random::u64()};
+                ChaosControl<fountain_t> chaosControl;
 
                 explicit OutputModule()
                     : EmpathModule(PARAMS_LEN, OUTPUTS_LEN)
@@ -2175,6 +2327,7 @@ namespace Sapphire
                 void OutputModule_initialize()
                 {
                     firstSoloFader.snapToFront();
+                    chaosControl.initialize();
                 }
 
                 void onReset(const ResetEvent& e) override
@@ -2221,6 +2374,7 @@ namespace Sapphire
                     const ForwardMessage inMessage = receiveMessageOrDefault();
                     chainIndex = inMessage.chainIndex;
                     backMessage.soloCount = inMessage.soloCount;
+                    backMessage.chainLength = std::max(0, inMessage.chainIndex);
                     backMessage.spectrumPowerScale = spectrumPower();
 
                     includeNeonModeMenuItem = !inMessage.valid;
@@ -2236,10 +2390,7 @@ namespace Sapphire
                         seedToRestore = 0;
                     }
 
-                    if (!inMessage.chaos.frozen)
-                        fountain.update(inMessage.chaos.dt);
-
-                    const batch_t batch = fountain.getBatch(inMessage.chaos.levelKnob);
+                    const batch_t batch = UpdateChaos(fountain, chaosControl, inMessage);
 
                     Frame audio = outputAudioFrame(
                         inMessage.dryAudio,
@@ -151,26 +151,66 @@ namespace Sapphire
         };
 
 
+        // Tank sizes before scaling by the bigness knob.
+        // Tank 12 is the modulated input delay, whose length is always ModDelay.
+        constexpr int TankSize[12] =
+        {
+            4801, 2909, 1153,  461,
+            7607, 4217, 2269, 1597,
+            3407, 1823,  859,  331
+        };
+
+        constexpr int ModDelay = 256;
+
+        // Buffer sizes that Engine and FastEngine allocate for each tank.
+        constexpr int TankBufferSize[NDELAYS] =
+        {
+             9700, 6000, 2320,  940,
+            15220, 8460, 4540, 3200,
+             6480, 3660, 1720,  680,
+             3111
+        };
+
+
+        template <typename value_t>
+        inline void MixLastRef(int cycle, value_t lastRef[MAXCYCLE + 1], const value_t& sample)
+        {
+            // The tanks are updated once every `cycle` samples at sample rates above 44.1 kHz.
+            // Interpolate the reverb output across the samples in between.
+            // Every engine calls this, so their results match exactly.
+            switch (cycle)
+            {
+            case 4:
+                lastRef[0] = lastRef[4];
+                lastRef[2] = (lastRef[0] + sample)/2;
+                lastRef[1] = (lastRef[0] + lastRef[2])/2;
+                lastRef[3] = (lastRef[2] + sample)/2;
+                lastRef[4] = sample;
+                break;
+
+            case 3:
+                lastRef[0] = lastRef[3];
+                lastRef[2] = (lastRef[0] + lastRef[0] + sample) / 3;
+                lastRef[1] = (lastRef[0] + sample + sample) / 3;
+                lastRef[3] = sample;
+                break;
+
+            case 2:
+                lastRef[0] = lastRef[2];
+                lastRef[1] = (lastRef[0] + sample)/2;
+                lastRef[2] = sample;
+                break;
+
+            case 1:
+                lastRef[0] = sample;
+                break;
+            }
+        }
+
+
         struct Engine
         {
         private:
-            // Structure
-            const int tankSize[12] =
-            {
-                4801,
-                2909,
-                1153,
-                 461,
-                7607,
-                4217,
-                2269,
-                1597,
-                3407,
-                1823,
-                 859,
-                 331
-            };
-
             // Parameters
             float replaceKnob = 0.5;
             float brightKnob = 0.5;
@@ -285,53 +325,11 @@ namespace Sapphire
                     access(channel, 12, delay[12].reverse(index+1)) * (frc);
             }
 
-            void mix(const StereoFrame& sample)
-            {
-                switch (cycle)
-                {
-                case 4:
-                    lastRef[0] = lastRef[4];
-                    lastRef[2] = (lastRef[0] + sample)/2;
-                    lastRef[1] = (lastRef[0] + lastRef[2])/2;
-                    lastRef[3] = (lastRef[2] + sample)/2;
-                    lastRef[4] = sample;
-                    break;
-
-                case 3:
-                    lastRef[0] = lastRef[3];
-                    lastRef[2] = (lastRef[0] + lastRef[0] + sample) / 3;
-                    lastRef[1] = (lastRef[0] + sample + sample) / 3;
-                    lastRef[3] = sample;
-                    break;
-
-                case 2:
-                    lastRef[0] = lastRef[2];
-                    lastRef[1] = (lastRef[0] + sample)/2;
-                    lastRef[2] = sample;
-                    break;
-
-                case 1:
-                    lastRef[0] = sample;
-                    break;
-                }
-            }
-
         public:
             Engine()
             {
-                delay[ 0].buffer.resize( 9700);
-                delay[ 1].buffer.resize( 6000);
-                delay[ 2].buffer.resize( 2320);
-                delay[ 3].buffer.resize(  940);
-                delay[ 4].buffer.resize(15220);
-                delay[ 5].buffer.resize( 8460);
-                delay[ 6].buffer.resize( 4540);
-                delay[ 7].buffer.resize( 3200);
-                delay[ 8].buffer.resize( 6480);
-                delay[ 9].buffer.resize( 3660);
-                delay[10].buffer.resize( 1720);
-                delay[11].buffer.resize(  680);
-                delay[12].buffer.resize( 3111);
+                for (int i = 0; i < NDELAYS; ++i)
+                    delay[i].buffer.resize(TankBufferSize[i]);
                 initialize();
             }
 
@@ -390,8 +388,8 @@ namespace Sapphire
 
                 // Update tank sizes as the bigness knob is adjusted.
                 for (int i = 0; i < 12; ++i)
-                    delay[i].delay = tankSize[i] * size;
-                delay[12].delay = 256;
+                    delay[i].delay = TankSize[i] * size;
+                delay[12].delay = ModDelay;
 
                 // ??? Do not allow silence? Add a teensy bit of noise?
                 if (std::abs(inputSampleL) < 1.18e-23) inputSampleL = fpd[0] * 1.18e-17;
@@ -417,7 +415,7 @@ namespace Sapphire
                     write(4, read(0));
                     StereoQuad f = read(4);
                     feedback = stir(f);
-                    mix(f.sum() / 8);
+                    MixLastRef(cycle, lastRef, f.sum() / 8);
                     cycle = 0;
                 }
                 iirB = iirB*(1-lowpass) + lastRef[cycle]*lowpass;
@@ -426,5 +424,654 @@ namespace Sapphire
                 outputSampleR = dither(sample.channel[1], fpd[1]);
             }
         };
+
+
+        inline double DitherScale(int expon)
+        {
+            // Returns exactly TwoToPower(expon + 62.0), the same value Engine uses for dithering,
+            // from a cache covering every exponent a finite float can have.
+            static constexpr int MinExponent = -150;
+            static constexpr int MaxExponent = +130;
+            static const std::vector<double> table = []()
+            {
+                std::vector<double> t;
+                for (int e = MinExponent; e <= MaxExponent; ++e)
+                    t.push_back(TwoToPower(e + 62.0));
+                return t;
+            }();
+
+            if (expon < MinExponent || expon > MaxExponent)
+                return TwoToPower(expon + 62.0);
+            return table[expon - MinExponent];
+        }
+
+
+        inline double DitherSample(double sample, uint32_t& fpd)
+        {
+            // Same as Engine::dither, using the cached powers of two.
+            int expon;
+            frexpf((float)sample, &expon);
+            fpd ^= fpd << 13;
+            fpd ^= fpd >> 17;
+            fpd ^= fpd << 5;
+            return sample + ((double(fpd)-uint32_t(0x7fffffff)) * 5.5e-36l * DitherScale(expon));
+        }
+
+
+        template <typename real_t>
+        struct TankQuad
+        {
+            // One stereo frame from each of 4 tanks, laid out as [channel][tank],
+            // so that each channel can be processed with SIMD operations across the tanks.
+            real_t ch[2][4];
+
+            void clear()
+            {
+                for (int c = 0; c < 2; ++c)
+                    for (int i = 0; i < 4; ++i)
+                        ch[c][i] = 0;
+            }
+
+            TankQuad stir() const
+            {
+                // Same operation order as Engine::stir, so double precision results match exactly.
+                TankQuad g;
+                for (int c = 0; c < 2; ++c)
+                {
+                    const real_t *f = ch[c];
+                    g.ch[c][0] = f[0] - ((f[1] + f[2]) + f[3]);
+                    g.ch[c][1] = f[1] - ((f[0] + f[2]) + f[3]);
+                    g.ch[c][2] = f[2] - ((f[0] + f[1]) + f[3]);
+                    g.ch[c][3] = f[3] - ((f[0] + f[1]) + f[2]);
+                }
+                return g;
+            }
+
+            real_t sum(int c) const
+            {
+                return ((ch[c][0] + ch[c][1]) + ch[c][2]) + ch[c][3];
+            }
+        };
+
+
+        template <>
+        inline TankQuad<float> TankQuad<float>::stir() const
+        {
+            TankQuad<float> g;
+            for (int c = 0; c < 2; ++c)
+            {
+                // f = [f0, f1, f2, f3]
+                // a = [f1, f0, f0, f0]
+                // b = [f2, f2, f1, f1]
+                // d = [f3, f3, f3, f2]
+                // g = f - ((a + b) + d)
+                const __m128 f = _mm_loadu_ps(ch[c]);
+                const __m128 a = _mm_shuffle_ps(f, f, _MM_SHUFFLE(0, 0, 0, 1));
+                const __m128 b = _mm_shuffle_ps(f, f, _MM_SHUFFLE(1, 1, 2, 2));
+                const __m128 d = _mm_shuffle_ps(f, f, _MM_SHUFFLE(2, 3, 3, 3));
+                _mm_storeu_ps(g.ch[c], _mm_sub_ps(f, _mm_add_ps(_mm_add_ps(a, b), d)));
+            }
+            return g;
+        }
+
+
+        template <typename real_t>
+        struct FastEngine
+        {
+            // A faster implementation of the same algorithm as Engine.
+            // All 13 tanks are stored in one contiguous arena of interleaved left/right samples,
+            // tank positions are calculated without bounds checking (they are always in range
+            // by construction), and each group of 4 tanks is processed as a TankQuad.
+            // FastEngine<double> produces exactly the same output as Engine.
+            // FastEngine<float> stores and processes audio in single precision;
+            // its output differs from Engine by a small amount (see GalaxyTest).
+
+        private:
+            // Parameters
+            float replaceKnob = 0.5;
+            float brightKnob = 0.5;
+            float detuneKnob = 0.5;
+            float bignessKnob = 1.0;
+            float mixKnob = 1.0;
+
+            // State
+            uint32_t fpd[2];
+            double depthM;
+            double vibM;
+            double oldfpd;
+            int cycle;
+            std::vector<real_t> arena;
+            int base[NDELAYS];          // frame index in `arena` where each tank starts
+            int count[NDELAYS];         // index of next write position in each tank
+            int delay[NDELAYS];         // tank size - written on every process() call
+            TankQuad<real_t> feedback;
+            real_t iirA[2];
+            real_t iirB[2];
+            real_t lastRef[2][MAXCYCLE + 1];    // [channel][cycle]
+
+            real_t* frame(int tankIndex, int sampleIndex)
+            {
+                return &arena[2 * static_cast<std::size_t>(base[tankIndex] + sampleIndex)];
+            }
+
+            int reverse(int tankIndex, int length) const
+            {
+                return length - ((length > delay[tankIndex]) ? (delay[tankIndex] + 1) : 0);
+            }
+
+            void advance(int tankIndex)
+            {
+                int& c = count[tankIndex];
+                ++c;
+                if (c < 0 || c > delay[tankIndex])
+                    c = 0;
+            }
+
+            void write(int tankIndex, real_t left, real_t right)
+            {
+                real_t *f = frame(tankIndex, count[tankIndex]);
+                f[0] = left;
+                f[1] = right;
+                advance(tankIndex);
+            }
+
+            TankQuad<real_t> read(int tankStartIndex)
+            {
+                TankQuad<real_t> q;
+                for (int i = 0; i < 4; ++i)
+                {
+                    const int t = tankStartIndex + i;
+                    const real_t *f = frame(t, reverse(t, count[t]));
+                    q.ch[0][i] = f[0];
+                    q.ch[1][i] = f[1];
+                }
+                return q;
+            }
+
+            void write(int tankStartIndex, const TankQuad<real_t>& q)
+            {
+                const TankQuad<real_t> g = q.stir();
+                for (int i = 0; i < 4; ++i)
+                    write(tankStartIndex + i, g.ch[0][i], g.ch[1][i]);
+            }
+
+            void reflect(int tankStartIndex, const real_t sample[2], real_t regen)
+            {
+                // The feedback is flipped: left feeds right and right feeds left.
+                for (int i = 0; i < 4; ++i)
+                    write(tankStartIndex + i, sample[0] + feedback.ch[1][i]*regen, sample[1] + feedback.ch[0][i]*regen);
+            }
+
+            real_t interp(int channel, double radians)
+            {
+                double ofs = (std::sin(vibM + radians) + 1) * 127;
+                double frc = ofs - std::floor(ofs);
+                int index = count[12] + ofs;
+                return
+                    frame(12, reverse(12, index))[channel] * static_cast<real_t>(1-frc) +
+                    frame(12, reverse(12, index+1))[channel] * static_cast<real_t>(frc);
+            }
+
+        public:
+            FastEngine()
+            {
+                int total = 0;
+                for (int i = 0; i < NDELAYS; ++i)
+                {
+                    base[i] = total;
+                    total += TankBufferSize[i];
+                }
+                arena.resize(2 * static_cast<std::size_t>(total));
+                initialize();
+            }
+
+            void initialize()
+            {
+                fpd[0] = 2756923396;
+                fpd[1] = 2341963165;
+                depthM = 0;
+                vibM = 3;
+                oldfpd = 429496.7295;
+                cycle = 0;
+                for (int i = 0; i < NDELAYS; ++i)
+                {
+                    count[i] = 1;
+                    delay[i] = 0;
+                }
+                for (real_t& x : arena)
+                    x = 0;
+                for (int i = 0; i <= MAXCYCLE; ++i)
+                    lastRef[0][i] = lastRef[1][i] = 0;
+                feedback.clear();
+                iirA[0] = iirA[1] = 0;
+                iirB[0] = iirB[1] = 0;
+            }
+
+            double getReplace()     const { return replaceKnob; }
+            double getBrightness()  const { return brightKnob;  }
+            double getDetune()      const { return detuneKnob;  }
+            double getBigness()     const { return bignessKnob; }
+            double getMix()         const { return mixKnob;     }
+
+            void setReplace(double replace)         { replaceKnob = ParamClamp(replace);    }
+            void setBrightness(double brightness)   { brightKnob  = ParamClamp(brightness); }
+            void setDetune(double detune)           { detuneKnob  = ParamClamp(detune);     }
+            void setBigness(double bigness)         { bignessKnob = ParamClamp(bigness);    }
+            void setMix(double mix)                 { mixKnob     = ParamClamp(mix);        }
+
+            void process(float sampleRate, float inLeft, float inRight, float& outLeft, float& outRight)
+            {
+                double resultLeft, resultRight;
+                process(sampleRate, inLeft, inRight, resultLeft, resultRight);
+                outLeft = static_cast<float>(resultLeft);
+                outRight = static_cast<float>(resultRight);
+            }
+
+            void process(double sampleRateHz, double inputSampleL, double inputSampleR, double& outputSampleL, double& outputSampleR)
+            {
+                const double overallscale = sampleRateHz / 44100;
+                const int cycleEnd = std::clamp<int>(std::floor(overallscale), MinCycle, MAXCYCLE);
+
+                if (cycle > cycleEnd-1)
+                    cycle = cycleEnd-1;
+
+                // Map knob values onto internal parameter values.
+                const double regen = 0.0625+((1.0-replaceKnob)*0.0625);
+                const double attenuate = (1.0 - (regen / 0.125))*1.333;
+                const double lowpass = Square(1.00001-(1.0-brightKnob))/std::sqrt(overallscale);
+                const double drift = Cube(detuneKnob)*0.001;
+                const double size = (bignessKnob*1.77)+0.1;
+                const double wet = 1 - Cube(1 - mixKnob);
+
+                // Update tank sizes as the bigness knob is adjusted.
+                for (int i = 0; i < 12; ++i)
+                    delay[i] = TankSize[i] * size;
+                delay[12] = ModDelay;
+
+                if (std::abs(inputSampleL) < 1.18e-23) inputSampleL = fpd[0] * 1.18e-17;
+                if (std::abs(inputSampleR) < 1.18e-23) inputSampleR = fpd[1] * 1.18e-17;
+                const real_t dry[2] = { static_cast<real_t>(inputSampleL), static_cast<real_t>(inputSampleR) };
+
+                vibM += oldfpd * drift;
+                if (vibM > 2*M_PI)
+                {
+                    vibM = 0;
+                    oldfpd = 0.4294967295 + (fpd[0] * 0.0000000000618);
+                }
+
+                write(12, static_cast<real_t>(inputSampleL * attenuate), static_cast<real_t>(inputSampleR * attenuate));
+
+                const real_t phasor[2] = { interp(0, 0), interp(1, M_PI_2) };
+                const real_t lp = static_cast<real_t>(lowpass);
+                const real_t lpc = static_cast<real_t>(1-lowpass);
+                for (int c = 0; c < 2; ++c)
+                    iirA[c] = iirA[c]*lpc + phasor[c]*lp;
+
+                if (++cycle == cycleEnd)
+                {
+                    reflect(8, iirA, static_cast<real_t>(regen));
+                    write(0, read(8));
+                    write(4, read(0));
+                    TankQuad<real_t> f = read(4);
+                    feedback = f.stir();
+                    for (int c = 0; c < 2; ++c)
+                        MixLastRef(cycle, lastRef[c], f.sum(c) / 8);
+                    cycle = 0;
+                }
+
+                const real_t w = static_cast<real_t>(wet);
+                const real_t d = static_cast<real_t>(1-wet);
+                real_t sample[2];
+                for (int c = 0; c < 2; ++c)
+                {
+                    iirB[c] = iirB[c]*lpc + lastRef[c][cycle]*lp;
+                    sample[c] = iirB[c]*w + dry[c]*d;
+                }
+                outputSampleL = DitherSample(sample[0], fpd[0]);
+                outputSampleR = DitherSample(sample[1], fpd[1]);
+            }
+        };
+
+
+        struct PolyEngine
+        {
+            // Runs up to MaxVoices independent stereo reverbs (16 channels) that share the same knob settings.
+            // Because every voice has the same tank sizes, all voices move through their tanks in lockstep.
+            // Each tank frame holds one float per lane: the left channels of all voices,
+            // followed by the right channels of all voices, padded to a multiple of 4 lanes,
+            // so every frame is processed 4 lanes at a time with SSE.
+            // All tanks live in one arena sized for the largest tanks the bigness knob can produce.
+            // Voice 0 produces exactly the same output as FastEngine<float>.
+
+            static constexpr int MaxVoices = 8;
+            static constexpr int MaxLanes = 2 * MaxVoices;
+
+        private:
+            const int nvoices;
+            const int half;             // index of the first right channel lane
+            const int stride;           // floats per tank frame, a multiple of 4
+
+            // Parameters
+            float replaceKnob = 0.5;
+            float brightKnob = 0.5;
+            float detuneKnob = 0.5;
+            float bignessKnob = 1.0;
+            float mixKnob = 1.0;
+
+            // State
+            uint32_t fpd[MaxLanes];
+            double depthM;
+            double vibM;
+            double oldfpd;
+            int cycle;
+            std::vector<float> arena;
+            int base[NDELAYS];          // frame index in `arena` where each tank starts
+            int count[NDELAYS];         // index of next write position in each tank
+            int delay[NDELAYS];         // tank size - written on every process() call
+            alignas(16) float feedback[4][MaxLanes];
+            alignas(16) float iirA[MaxLanes];
+            alignas(16) float iirB[MaxLanes];
+            PhysicsVector lastRef[MaxLanes/4][MAXCYCLE + 1];    // [4-lane group][cycle]
+
+            static int validateVoiceCount(int numVoices)
+            {
+                if (numVoices < 1 || numVoices > MaxVoices)
+                    throw std::range_error(std::string("Invalid number of Galaxy voices: ") + std::to_string(numVoices));
+                return numVoices;
+            }
+
+            float* frame(int tankIndex, int sampleIndex)
+            {
+                return &arena[static_cast<std::size_t>(base[tankIndex] + sampleIndex) * stride];
+            }
+
+            float* head(int tankIndex)
+            {
+                return frame(tankIndex, count[tankIndex]);
+            }
+
+            float* tail(int tankIndex)
+            {
+                return frame(tankIndex, reverse(tankIndex, count[tankIndex]));
+            }
+
+            int reverse(int tankIndex, int length) const
+            {
+                return length - ((length > delay[tankIndex]) ? (delay[tankIndex] + 1) : 0);
+            }
+
+            void advance(int tankIndex)
+            {
+                int& c = count[tankIndex];
+                ++c;
+                if (c < 0 || c > delay[tankIndex])
+                    c = 0;
+            }
+
+            void write(int tankIndex, const float *lanes)
+            {
+                float *f = head(tankIndex);
+                for (int k = 0; k < stride; k += 4)
+                    _mm_storeu_ps(f + k, _mm_load_ps(lanes + k));
+                advance(tankIndex);
+            }
+
+            static void stir(float *const g[4], const float *const f[4], int nlanes)
+            {
+                for (int k = 0; k < nlanes; k += 4)
+                {
+                    const __m128 f0 = _mm_loadu_ps(f[0] + k);
+                    const __m128 f1 = _mm_loadu_ps(f[1] + k);
+                    const __m128 f2 = _mm_loadu_ps(f[2] + k);
+                    const __m128 f3 = _mm_loadu_ps(f[3] + k);
+                    _mm_storeu_ps(g[0] + k, _mm_sub_ps(f0, _mm_add_ps(_mm_add_ps(f1, f2), f3)));
+                    _mm_storeu_ps(g[1] + k, _mm_sub_ps(f1, _mm_add_ps(_mm_add_ps(f0, f2), f3)));
+                    _mm_storeu_ps(g[2] + k, _mm_sub_ps(f2, _mm_add_ps(_mm_add_ps(f0, f1), f3)));
+                    _mm_storeu_ps(g[3] + k, _mm_sub_ps(f3, _mm_add_ps(_mm_add_ps(f0, f1), f2)));
+                }
+            }
+
+            void transfer(int dstTankStartIndex, int srcTankStartIndex)
+            {
+                // Same as Engine::write(dst, read(src)).
+                const float *f[4];
+                float *g[4];
+                for (int i = 0; i < 4; ++i)
+                {
+                    f[i] = tail(srcTankStartIndex + i);
+                    g[i] = head(dstTankStartIndex + i);
+                }
+                stir(g, f, stride);
+                for (int i = 0; i < 4; ++i)
+                    advance(dstTankStartIndex + i);
+            }
+
+            void reflect(int tankStartIndex, float regen)
+            {
+                // The feedback is flipped: left lanes feed right lanes and right lanes feed left lanes.
+                const __m128 r = _mm_set1_ps(regen);
+                for (int i = 0; i < 4; ++i)
+                {
+                    float *f = head(tankStartIndex + i);
+                    if (half % 4 == 0)
+                    {
+                        for (int k = 0; k < half; k += 4)
+                        {
+                            _mm_storeu_ps(f + k,        _mm_add_ps(_mm_load_ps(iirA + k),        _mm_mul_ps(_mm_loadu_ps(feedback[i] + half + k), r)));
+                            _mm_storeu_ps(f + half + k, _mm_add_ps(_mm_loadu_ps(iirA + half + k), _mm_mul_ps(_mm_load_ps(feedback[i] + k),        r)));
+                        }
+                    }
+                    else
+                    {
+                        for (int k = 0; k < half; ++k)
+                        {
+                            f[k]        = iirA[k]        + feedback[i][half + k]*regen;
+                            f[half + k] = iirA[half + k] + feedback[i][k]*regen;
+                        }
+                    }
+                    advance(tankStartIndex + i);
+                }
+            }
+
+            void interp(float *phasor, int firstLane, double radians)
+            {
+                double ofs = (std::sin(vibM + radians) + 1) * 127;
+                double frc = ofs - std::floor(ofs);
+                int index = count[12] + ofs;
+                const float *a = frame(12, reverse(12, index)) + firstLane;
+                const float *b = frame(12, reverse(12, index+1)) + firstLane;
+                const float fa = static_cast<float>(1-frc);
+                const float fb = static_cast<float>(frc);
+                if (half % 4 == 0)
+                {
+                    const __m128 wa = _mm_set1_ps(fa);
+                    const __m128 wb = _mm_set1_ps(fb);
+                    for (int k = 0; k < half; k += 4)
+                        _mm_storeu_ps(phasor + firstLane + k, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a + k), wa), _mm_mul_ps(_mm_loadu_ps(b + k), wb)));
+                }
+                else
+                {
+                    for (int k = 0; k < half; ++k)
+                        phasor[firstLane + k] = a[k]*fa + b[k]*fb;
+                }
+            }
+
+        public:
+            explicit PolyEngine(int numVoices = MaxVoices)
+                : nvoices(validateVoiceCount(numVoices))
+                , half(numVoices)
+                , stride(4 * ((2*numVoices + 3) / 4))
+            {
+                // Size each tank for the largest delay that process() can calculate.
+                const double maxSize = (ParamKnobMax*1.77)+0.1;
+                int total = 0;
+                for (int i = 0; i < 12; ++i)
+                {
+                    base[i] = total;
+                    total += static_cast<int>(TankSize[i] * maxSize) + 1;
+                }
+
+                // Tank 12 has a fixed delay.
+                base[12] = total;
+                total += ModDelay + 1;
+
+                arena.resize(static_cast<std::size_t>(total) * stride);
+                initialize();
+            }
+
+            int voices() const
+            {
+                return nvoices;
+            }
+
+            std::size_t memoryBytes() const
+            {
+                return sizeof(PolyEngine) + arena.size()*sizeof(float);
+            }
+
+            void initialize()
+            {
+                // Voice 0 starts with the same dither state as Engine.
+                // The other voices get different seeds so their dither noise is uncorrelated.
+                for (int k = 0; k < MaxLanes; ++k)
+                    fpd[k] = 1;
+                for (int v = 0; v < nvoices; ++v)
+                {
+                    const uint32_t spread = static_cast<uint32_t>(v) * 0x9e3779b9u;
+                    fpd[v] = 2756923396u + spread;
+                    fpd[v + half] = 2341963165u + spread;
+                    if (fpd[v] == 0) fpd[v] = 1;
+                    if (fpd[v + half] == 0) fpd[v + half] = 1;
+                }
+                depthM = 0;
+                vibM = 3;
+                oldfpd = 429496.7295;
+                cycle = 0;
+                for (int i = 0; i < NDELAYS; ++i)
+                {
+                    count[i] = 1;
+                    delay[i] = 0;
+                }
+                for (float& x : arena)
+                    x = 0;
+                for (int k = 0; k < MaxLanes; ++k)
+                {
+                    for (int i = 0; i < 4; ++i)
+                        feedback[i][k] = 0;
+                    iirA[k] = 0;
+                    iirB[k] = 0;
+                }
+                for (int g = 0; g < MaxLanes/4; ++g)
+                    for (int i = 0; i <= MAXCYCLE; ++i)
+                        lastRef[g][i] = PhysicsVector::zero();
+            }
+
+            double getReplace()     const { return replaceKnob; }
+            double getBrightness()  const { return brightKnob;  }
+            double getDetune()      const { return detuneKnob;  }
+            double getBigness()     const { return bignessKnob; }
+            double getMix()         const { return mixKnob;     }
+
+            void setReplace(double replace)         { replaceKnob = ParamClamp(replace);    }
+            void setBrightness(double brightness)   { brightKnob  = ParamClamp(brightness); }
+            void setDetune(double detune)           { detuneKnob  = ParamClamp(detune);     }
+            void setBigness(double bigness)         { bignessKnob = ParamClamp(bigness);    }
+            void setMix(double mix)                 { mixKnob     = ParamClamp(mix);        }
+
+            void process(double sampleRateHz, const float *inLeft, const float *inRight, float *outLeft, float *outRight)
+            {
+                // Each array holds one sample per voice.
+                const double overallscale = sampleRateHz / 44100;
+                const int cycleEnd = std::clamp<int>(std::floor(overallscale), MinCycle, MAXCYCLE);
+
+                if (cycle > cycleEnd-1)
+                    cycle = cycleEnd-1;
+
+                // Map knob values onto internal parameter values.
+                const double regen = 0.0625+((1.0-replaceKnob)*0.0625);
+                const double attenuate = (1.0 - (regen / 0.125))*1.333;
+                const double lowpass = Square(1.00001-(1.0-brightKnob))/std::sqrt(overallscale);
+                const double drift = Cube(detuneKnob)*0.001;
+                const double size = (bignessKnob*1.77)+0.1;
+                const double wet = 1 - Cube(1 - mixKnob);
+
+                // Update tank sizes as the bigness knob is adjusted.
+                for (int i = 0; i < 12; ++i)
+                    delay[i] = TankSize[i] * size;
+                delay[12] = ModDelay;
+
+                alignas(16) float dry[MaxLanes]{};
+                alignas(16) float input[MaxLanes]{};
+                for (int v = 0; v < nvoices; ++v)
+                {
+                    for (int c = 0; c < 2; ++c)
+                    {
+                        const int lane = v + c*half;
+                        double x = (c == 0) ? inLeft[v] : inRight[v];
+                        if (std::abs(x) < 1.18e-23) x = fpd[lane] * 1.18e-17;
+                        dry[lane] = static_cast<float>(x);
+                        input[lane] = static_cast<float>(x * attenuate);
+                    }
+                }
+
+                vibM += oldfpd * drift;
+                if (vibM > 2*M_PI)
+                {
+                    vibM = 0;
+                    oldfpd = 0.4294967295 + (fpd[0] * 0.0000000000618);
+                }
+
+                write(12, input);
+
+                alignas(16) float phasor[MaxLanes]{};
+                interp(phasor, 0, 0);
+                interp(phasor, half, M_PI_2);
+
+                const __m128 lp = _mm_set1_ps(static_cast<float>(lowpass));
+                const __m128 lpc = _mm_set1_ps(static_cast<float>(1-lowpass));
+                for (int k = 0; k < stride; k += 4)
+                    _mm_store_ps(iirA + k, _mm_add_ps(_mm_mul_ps(_mm_load_ps(iirA + k), lpc), _mm_mul_ps(_mm_load_ps(phasor + k), lp)));
+
+                if (++cycle == cycleEnd)
+                {
+                    reflect(8, static_cast<float>(regen));
+                    transfer(0, 8);
+                    transfer(4, 0);
+
+                    const float *f[4];
+                    float *g[4];
+                    for (int i = 0; i < 4; ++i)
+                    {
+                        f[i] = tail(4 + i);
+                        g[i] = feedback[i];
+                    }
+                    stir(g, f, stride);
+
+                    const __m128 eight = _mm_set1_ps(8);
+                    for (int k = 0; k < stride; k += 4)
+                    {
+                        __m128 t = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_loadu_ps(f[0] + k), _mm_loadu_ps(f[1] + k)), _mm_loadu_ps(f[2] + k)), _mm_loadu_ps(f[3] + k));
+                        MixLastRef(cycle, lastRef[k/4], PhysicsVector(_mm_div_ps(t, eight)));
+                    }
+                    cycle = 0;
+                }
+
+                alignas(16) float sample[MaxLanes];
+                const __m128 w = _mm_set1_ps(static_cast<float>(wet));
+                const __m128 d = _mm_set1_ps(static_cast<float>(1-wet));
+                for (int k = 0; k < stride; k += 4)
+                {
+                    const __m128 b = _mm_add_ps(_mm_mul_ps(_mm_load_ps(iirB + k), lpc), _mm_mul_ps(lastRef[k/4][cycle].v, lp));
+                    _mm_store_ps(iirB + k, b);
+                    _mm_store_ps(sample + k, _mm_add_ps(_mm_mul_ps(b, w), _mm_mul_ps(_mm_load_ps(dry + k), d)));
+                }
+
+                for (int v = 0; v < nvoices; ++v)
+                {
+                    outLeft[v]  = static_cast<float>(DitherSample(sample[v],        fpd[v]));
+                    outRight[v] = static_cast<float>(DitherSample(sample[v + half], fpd[v + half]));
+                }
+            }
+        };
     }
 }
@@ -30,7 +30,7 @@ namespace Sapphire
             float mixKnob   = DefaultMixKnob;
             float gainKnob  = DefaultGainKnob;
 
-            StateVariableFilter<PhysicsVector> filter[maxquads];
+            QuadStateVariableFilter filter[maxquads];
 
             float setKnob(float &v, float k, int lo = 0, int hi = 1)
             {
@@ -78,6 +78,12 @@ namespace Sapphire
                 mode = m;
             }
 
+            void setTanMode(FilterTanMode m)
+            {
+                for (int q = 0; q < maxquads; ++q)
+                    filter[q].setTanMode(m);
+            }
+
             int process(float sampleRateHz, int nchannels, const float inFrame[], float outFrame[])
             {
                 if (nchannels < 1)
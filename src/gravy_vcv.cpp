@@ -60,6 +60,7 @@ namespace Sapphire
             AutomaticGainLimiter agc;
             bool enableAgc = false;
             EnumSmoother<FilterMode> smoother{FilterMode::Default, "", 0.01};
+            FilterTanMode tanMode = FilterTanMode::Default;
 
             GravyModule()
                 : SapphireModule(PARAMS_LEN, OUTPUTS_LEN)
@@ -104,6 +105,20 @@ namespace Sapphire
                 engine.initialize();
                 reflectAgcSlider();
                 smoother.initialize();
+                tanMode = FilterTanMode::Default;
+            }
+
+            json_t* dataToJson() override
+            {
+                json_t* root = SapphireModule::dataToJson();
+                jsonSetEnum(root, "tanMode", tanMode);
+                return root;
+            }
+
+            void dataFromJson(json_t* root) override
+            {
+                SapphireModule::dataFromJson(root);
+                jsonLoadEnum(root, "tanMode", tanMode);
             }
 
             bool getAgcEnabled() const { return enableAgc; }
@@ -165,6 +180,7 @@ namespace Sapphire
                     float smooth = smoother.process(args.sampleRate);
 
                     engine.setFilterMode(smoother.currentValue);
+                    engine.setTanMode(tanMode);
                     engine.setFrequency(freqKnob);
                     engine.setResonance(resKnob);
                     engine.setMix(mixKnob);
@@ -234,6 +250,15 @@ namespace Sapphire
                     menu->addChild(gravyModule->createToggleAllSensitivityMenuItem());
                     menu->addChild(gravyModule->createStereoSplitterMenuItem());
                     menu->addChild(gravyModule->createStereoMergeMenuItem());
+                    menu->addChild(CreateChangeEnumMenuItem(
+                        "Filter tuning",
+                        {
+                            "Exact",
+                            "Fast (uses less CPU with frequency modulation)"
+                        },
+                        "change filter tuning",
+                        gravyModule->tanMode
+                    ));
                 }
             }
         };
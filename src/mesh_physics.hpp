@@ -39,10 +39,61 @@ namespace Sapphire
 
     using BallList = std::vector<Ball>;
 
+    struct Spring
+    {
+        int ballIndex1;         // 0-based index into Mesh::ballList
+        int ballIndex2;         // 0-based index into Mesh::ballList
+
+        Spring(int _ballIndex1, int _ballIndex2)
+            : ballIndex1(_ballIndex1)
+            , ballIndex2(_ballIndex2)
+            {}
+    };
+
+    using SpringList = std::vector<Spring>;
+
     const float MESH_DEFAULT_STIFFNESS = 10.0;
     const float MESH_DEFAULT_REST_LENGTH = 1.0e-3;
     const float MESH_DEFAULT_SPEED_LIMIT = 2.0;
 
+    struct SpringForceBatch
+    {
+        PhysicsVector force[4];
+    };
+
+    inline SpringForceBatch CalcSpringForces(
+        float stiffness,
+        float restLength,
+        const PhysicsVector& dr0,
+        const PhysicsVector& dr1,
+        const PhysicsVector& dr2,
+        const PhysicsVector& dr3)
+    {
+        // Calculates the forces of 4 springs from their displacement vectors.
+        // Transposing the vectors in registers puts each coordinate in its own register,
+        // so the 4 springs share one square root and one division, with no branches.
+        // Each lane performs the same operations as the unrolled scalar code, so the
+        // forces match exactly, except that a spring shorter than 1.0e-9 m contributes
+        // a zero force instead of being skipped.
+        const __m128 t0 = _mm_unpacklo_ps(dr0.v, dr1.v);     // x0 x1 y0 y1
+        const __m128 t1 = _mm_unpacklo_ps(dr2.v, dr3.v);     // x2 x3 y2 y3
+        const __m128 t2 = _mm_unpackhi_ps(dr0.v, dr1.v);     // z0 z1 w0 w1
+        const __m128 t3 = _mm_unpackhi_ps(dr2.v, dr3.v);     // z2 z3 w2 w3
+        const __m128 dx = _mm_movelh_ps(t0, t1);
+        const __m128 dy = _mm_movehl_ps(t1, t0);
+        const __m128 dz = _mm_movelh_ps(t2, t3);
+        const __m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+        __m128 scale = _mm_div_ps(_mm_mul_ps(_mm_set1_ps(stiffness), _mm_sub_ps(dist, _mm_set1_ps(restLength))), dist);
+        scale = _mm_and_ps(_mm_cmpge_ps(dist, _mm_set1_ps(1.0e-9f)), scale);
+
+        SpringForceBatch batch;
+        batch.force[0].v = _mm_mul_ps(_mm_shuffle_ps(scale, scale, _MM_SHUFFLE(0, 0, 0, 0)), dr0.v);
+        batch.force[1].v = _mm_mul_ps(_mm_shuffle_ps(scale, scale, _MM_SHUFFLE(1, 1, 1, 1)), dr1.v);
+        batch.force[2].v = _mm_mul_ps(_mm_shuffle_ps(scale, scale, _MM_SHUFFLE(2, 2, 2, 2)), dr2.v);
+        batch.force[3].v = _mm_mul_ps(_mm_shuffle_ps(scale, scale, _MM_SHUFFLE(3, 3, 3, 3)), dr3.v);
+        return batch;
+    }
+
     class PhysicsMesh
     {
     protected:
@@ -0,0 +1,382 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include "mesh_runtime.hpp"
+
+// Sapphire mesh physics engine, by Don Cross <cosinekitty@gmail.com>
+// https://github.com/cosinekitty/sapphire
+
+namespace Sapphire
+{
+    static const char MeshFileMagic[4] = {'S', 'M', 'S', 'H'};
+    static const uint32_t MeshFileVersion = 1;
+
+
+    class MeshEncoder
+    {
+    private:
+        std::vector<uint8_t>& data;
+
+    public:
+        explicit MeshEncoder(std::vector<uint8_t>& _data)
+            : data(_data)
+            {}
+
+        void magic()
+        {
+            for (char c : MeshFileMagic)
+                data.push_back(static_cast<uint8_t>(c));
+        }
+
+        void u32(uint32_t x)
+        {
+            for (int i = 0; i < 4; ++i)
+                data.push_back(static_cast<uint8_t>(x >> (8*i)));
+        }
+
+        void i32(int32_t x)
+        {
+            u32(static_cast<uint32_t>(x));
+        }
+
+        void f32(float x)
+        {
+            uint32_t u;
+            std::memcpy(&u, &x, sizeof(u));
+            u32(u);
+        }
+
+        void vec(const PhysicsVector& v)
+        {
+            f32(v[0]);
+            f32(v[1]);
+            f32(v[2]);
+        }
+    };
+
+
+    class MeshDecoder
+    {
+    private:
+        const std::vector<uint8_t>& data;
+        std::size_t offset = 0;
+
+    public:
+        explicit MeshDecoder(const std::vector<uint8_t>& _data)
+            : data(_data)
+            {}
+
+        void need(std::size_t nbytes) const
+        {
+            if (offset + nbytes > data.size())
+                throw std::runtime_error("Mesh data is truncated.");
+        }
+
+        void magic()
+        {
+            need(sizeof(MeshFileMagic));
+            if (std::memcmp(&data[offset], MeshFileMagic, sizeof(MeshFileMagic)))
+                throw std::runtime_error("Mesh data does not begin with the expected signature.");
+            offset += sizeof(MeshFileMagic);
+        }
+
+        uint32_t u32()
+        {
+            need(4);
+            uint32_t x = 0;
+            for (int i = 0; i < 4; ++i)
+                x |= static_cast<uint32_t>(data[offset++]) << (8*i);
+            return x;
+        }
+
+        int32_t i32()
+        {
+            return static_cast<int32_t>(u32());
+        }
+
+        float f32()
+        {
+            uint32_t u = u32();
+            float x;
+            std::memcpy(&x, &u, sizeof(x));
+            return x;
+        }
+
+        PhysicsVector vec()
+        {
+            float x = f32();
+            float y = f32();
+            float z = f32();
+            return PhysicsVector(x, y, z, 0.0f);
+        }
+
+        bool atEnd() const
+        {
+            return offset == data.size();
+        }
+    };
+
+
+    static bool IsValidIndex(int index, std::size_t count)
+    {
+        return index >= 0 && static_cast<std::size_t>(index) < count;
+    }
+
+
+    static void ValidateMesh(const MeshDescription& desc)
+    {
+        const int nballs = static_cast<int>(desc.balls.size());
+
+        // Mobile balls must come first, followed by anchors.
+        int nmobile = 0;
+        while (nmobile < nballs && desc.balls[nmobile].IsMobile())
+            ++nmobile;
+
+        for (int i = nmobile; i < nballs; ++i)
+            if (desc.balls[i].IsMobile())
+                throw std::runtime_error("Mesh has a mobile ball after the first anchor: " + std::to_string(i));
+
+        for (const Ball& b : desc.balls)
+            if (!b.pos.isFinite3d() || !std::isfinite(b.mass))
+                throw std::runtime_error("Mesh has a ball with a non-finite mass or position.");
+
+        for (const Spring& s : desc.springs)
+        {
+            if (!IsValidIndex(s.ballIndex1, desc.balls.size()) || !IsValidIndex(s.ballIndex2, desc.balls.size()))
+                throw std::runtime_error("Mesh has a spring with an invalid ball index.");
+
+            if (s.ballIndex1 == s.ballIndex2)
+                throw std::runtime_error("Mesh has a spring that connects a ball to itself.");
+
+            if (desc.balls[s.ballIndex1].IsAnchor() && desc.balls[s.ballIndex2].IsAnchor())
+                throw std::runtime_error("Mesh has a spring that connects two anchors.");
+        }
+
+        const MeshAudioParameters& mp = desc.audio;
+        for (int index : {mp.leftInputBallIndex, mp.rightInputBallIndex, mp.leftOutputBallIndex, mp.rightOutputBallIndex})
+            if (!IsValidIndex(index, desc.balls.size()))
+                throw std::runtime_error("Mesh has an invalid audio input/output ball index.");
+
+        for (int index : {mp.leftVarMassBallIndex, mp.rightVarMassBallIndex})
+            if (!IsValidIndex(index, desc.balls.size()) || desc.balls[index].IsAnchor())
+                throw std::runtime_error("Mesh variable mass balls must be valid mobile balls.");
+    }
+
+
+    std::vector<uint8_t> EncodeMesh(const MeshDescription& desc)
+    {
+        ValidateMesh(desc);
+
+        std::vector<uint8_t> data;
+        MeshEncoder enc(data);
+        enc.magic();
+        enc.u32(MeshFileVersion);
+        enc.u32(static_cast<uint32_t>(desc.balls.size()));
+        enc.u32(static_cast<uint32_t>(desc.springs.size()));
+
+        for (const Ball& b : desc.balls)
+        {
+            enc.f32(b.mass);
+            enc.vec(b.pos);
+        }
+
+        for (const Spring& s : desc.springs)
+        {
+            enc.u32(static_cast<uint32_t>(s.ballIndex1));
+            enc.u32(static_cast<uint32_t>(s.ballIndex2));
+        }
+
+        const MeshAudioParameters& mp = desc.audio;
+        enc.i32(mp.leftInputBallIndex);
+        enc.i32(mp.rightInputBallIndex);
+        enc.i32(mp.leftOutputBallIndex);
+        enc.i32(mp.rightOutputBallIndex);
+        enc.i32(mp.leftVarMassBallIndex);
+        enc.i32(mp.rightVarMassBallIndex);
+        enc.vec(mp.leftInputDir1);
+        enc.vec(mp.leftInputDir2);
+        enc.vec(mp.rightInputDir1);
+        enc.vec(mp.rightInputDir2);
+        enc.vec(mp.leftOutputDir1);
+        enc.vec(mp.leftOutputDir2);
+        enc.vec(mp.rightOutputDir1);
+        enc.vec(mp.rightOutputDir2);
+
+        return data;
+    }
+
+
+    MeshDescription DecodeMesh(const std::vector<uint8_t>& data)
+    {
+        MeshDecoder dec(data);
+        dec.magic();
+
+        uint32_t version = dec.u32();
+        if (version != MeshFileVersion)
+            throw std::runtime_error("Unsupported mesh data version: " + std::to_string(version));
+
+        const uint32_t nballs = dec.u32();
+        const uint32_t nsprings = dec.u32();
+
+        // Verify the sizes before allocating anything, in case the header is corrupt.
+        dec.need(16*static_cast<std::size_t>(nballs) + 8*static_cast<std::size_t>(nsprings));
+
+        MeshDescription desc;
+        desc.balls.reserve(nballs);
+        for (uint32_t i = 0; i < nballs; ++i)
+        {
+            float mass = dec.f32();
+            PhysicsVector pos = dec.vec();
+            desc.balls.push_back(Ball(mass, pos, PhysicsVector::zero()));
+        }
+
+        desc.springs.reserve(nsprings);
+        for (uint32_t i = 0; i < nsprings; ++i)
+        {
+            int32_t a = dec.i32();
+            int32_t b = dec.i32();
+            desc.springs.push_back(Spring(a, b));
+        }
+
+        MeshAudioParameters& mp = desc.audio;
+        mp.leftInputBallIndex = dec.i32();
+        mp.rightInputBallIndex = dec.i32();
+        mp.leftOutputBallIndex = dec.i32();
+        mp.rightOutputBallIndex = dec.i32();
+        mp.leftVarMassBallIndex = dec.i32();
+        mp.rightVarMassBallIndex = dec.i32();
+        mp.leftInputDir1 = dec.vec();
+        mp.leftInputDir2 = dec.vec();
+        mp.rightInputDir1 = dec.vec();
+        mp.rightInputDir2 = dec.vec();
+        mp.leftOutputDir1 = dec.vec();
+        mp.leftOutputDir2 = dec.vec();
+        mp.rightOutputDir1 = dec.vec();
+        mp.rightOutputDir2 = dec.vec();
+
+        if (!dec.atEnd())
+            throw std::runtime_error("Mesh data has extra bytes at the end.");
+
+        ValidateMesh(desc);
+        return desc;
+    }
+
+
+    MeshDescription ReadMeshFile(const std::string& filename)
+    {
+        FILE *infile = fopen(filename.c_str(), "rb");
+        if (infile == nullptr)
+            throw std::runtime_error("Cannot open mesh file for read: " + filename);
+
+        std::vector<uint8_t> data;
+        uint8_t buffer[4096];
+        std::size_t nread;
+        while ((nread = fread(buffer, 1, sizeof(buffer), infile)) > 0)
+            data.insert(data.end(), buffer, buffer + nread);
+        fclose(infile);
+
+        return DecodeMesh(data);
+    }
+
+
+    void WriteMeshFile(const std::string& filename, const MeshDescription& desc)
+    {
+        std::vector<uint8_t> data = EncodeMesh(desc);
+
+        FILE *outfile = fopen(filename.c_str(), "wb");
+        if (outfile == nullptr)
+            throw std::runtime_error("Cannot open mesh file for write: " + filename);
+
+        std::size_t nwritten = fwrite(data.data(), 1, data.size(), outfile);
+        fclose(outfile);
+        if (nwritten != data.size())
+            throw std::runtime_error("Error writing mesh file: " + filename);
+    }
+
+
+    RuntimeMesh::RuntimeMesh(const MeshDescription& desc)
+        : PhysicsMesh(desc.balls.size(), 0)
+        , audio(desc.audio)
+    {
+        ValidateMesh(desc);
+
+        for (const Ball& b : desc.balls)
+        {
+            AddBall(Ball(b.mass, b.pos, PhysicsVector::zero()));
+            if (b.IsMobile())
+                ++nmobile;
+        }
+        forceList.resize(nmobile, PhysicsVector::zero());
+
+        // Compile the springs into CSR form using a stable counting sort,
+        // so each row keeps the order the springs were listed in.
+        rowStart.resize(nmobile + 1, 0);
+        for (const Spring& s : desc.springs)
+        {
+            if (s.ballIndex1 < nmobile)
+                ++rowStart[s.ballIndex1 + 1];
+            if (s.ballIndex2 < nmobile)
+                ++rowStart[s.ballIndex2 + 1];
+        }
+
+        for (int i = 0; i < nmobile; ++i)
+            rowStart[i+1] += rowStart[i];
+
+        neighbor.resize(rowStart[nmobile]);
+        std::vector<int> fill(rowStart.begin(), rowStart.end() - 1);
+        for (const Spring& s : desc.springs)
+        {
+            if (s.ballIndex1 < nmobile)
+                neighbor[fill[s.ballIndex1]++] = s.ballIndex2;
+            if (s.ballIndex2 < nmobile)
+                neighbor[fill[s.ballIndex2]++] = s.ballIndex1;
+        }
+    }
+
+
+    void RuntimeMesh::Dampen(float damp)
+    {
+        for (int i = 0; i < nmobile; ++i)
+            currBallList[i].vel *= damp;
+    }
+
+
+    void RuntimeMesh::CalcForces(const BallList& blist)
+    {
+        const int *row = neighbor.data();
+        for (int i = 0; i < nmobile; ++i)
+        {
+            const PhysicsVector pos = blist[i].pos;
+            PhysicsVector force = Cross(blist[i].vel, magnet);
+            const int *end = neighbor.data() + rowStart[i+1];
+            for (; row < end; ++row)
+            {
+                // When this ball is the second ball in a spring, `dr` is exactly the negative
+                // of what the generated code calculates, so adding this term is the same as
+                // the generated code subtracting its own.
+                PhysicsVector dr = blist[*row].pos - pos;
+                float dist = Magnitude(dr);
+                if (dist >= 1.0e-9f)
+                    force += ((stiffness * (dist - restLength)) / dist) * dr;
+            }
+            forceList[i] = force;
+        }
+    }
+
+
+    void RuntimeMesh::Extrapolate(float dt)
+    {
+        const float speedLimitSquared = speedLimit * speedLimit;
+        for (int i = 0; i < nmobile; ++i)
+        {
+            const Ball& curr = currBallList[i];
+            Ball& next = nextBallList[i];
+            next.vel = curr.vel + ((dt / curr.mass) * forceList[i]);
+            float speedSquared = Quadrature(next.vel);
+            if (speedSquared > speedLimitSquared)
+                next.vel *= speedLimit / std::sqrt(speedSquared);
+            next.pos = curr.pos + ((dt/2) * (curr.vel + next.vel));
+        }
+    }
+}
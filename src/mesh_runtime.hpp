@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "mesh_physics.hpp"
+
+// Sapphire mesh physics engine, by Don Cross <cosinekitty@gmail.com>
+// https://github.com/cosinekitty/sapphire
+
+namespace Sapphire
+{
+    // MeshDescription is everything needed to build a mesh at runtime:
+    // the balls (mobile balls first, then anchors), the springs between them,
+    // and where audio goes in and comes out.
+
+    struct MeshDescription
+    {
+        BallList balls;
+        SpringList springs;
+        MeshAudioParameters audio;
+    };
+
+    // Compact binary file format for a MeshDescription. All values are little-endian.
+    //
+    //      char[4]     magic "SMSH"
+    //      uint32      version = 1
+    //      uint32      number of balls
+    //      uint32      number of springs
+    //      balls:      float mass (<= 0 for an anchor), float x, float y, float z
+    //      springs:    uint32 ballIndex1, uint32 ballIndex2
+    //      int32[6]    audio ball indices: left/right input, left/right output, left/right variable mass
+    //      float[24]   audio direction vectors (x, y, z each): left/right input dir1/dir2, left/right output dir1/dir2
+
+    std::vector<uint8_t> EncodeMesh(const MeshDescription& desc);
+    MeshDescription DecodeMesh(const std::vector<uint8_t>& data);     // throws std::runtime_error for invalid data
+    MeshDescription ReadMeshFile(const std::string& filename);        // throws std::runtime_error on failure
+    void WriteMeshFile(const std::string& filename, const MeshDescription& desc);
+
+
+    // RuntimeMesh simulates any mesh topology loaded at runtime,
+    // instead of relying on code generated by util/meshgen.cpp.
+    // Springs are compiled into a compressed sparse row (CSR) adjacency list:
+    // each mobile ball has a contiguous row of its neighbors, so the force on each ball
+    // is accumulated in a register without scattering partial forces to other balls.
+    // Each row lists neighbors in the order the springs appear in the description,
+    // so the forces add up in exactly the same order as the generated code.
+
+    class RuntimeMesh : public PhysicsMesh
+    {
+    private:
+        int nmobile = 0;
+        std::vector<int> rowStart;      // neighbors of mobile ball i are neighbor[rowStart[i] .. rowStart[i+1]-1]
+        std::vector<int> neighbor;
+        MeshAudioParameters audio;
+
+        void Dampen(float damp);
+        void CalcForces(const BallList& blist);
+        void Extrapolate(float dt);
+
+    public:
+        explicit RuntimeMesh(const MeshDescription& desc);
+
+        MeshAudioParameters getAudioParameters() const { return audio; }
+        int NumMobileBalls() const { return nmobile; }
+        int NumSpringRefs() const { return static_cast<int>(neighbor.size()); }
+
+        static float DampingFactor(float dt, float halflife)
+        {
+            return OneHalfToPower(dt/halflife);
+        }
+
+        void Update(float dt, float halflife)
+        {
+            Step(dt, DampingFactor(dt, halflife));
+        }
+
+        void Step(float dt, float damp)     // `damp` must be the value returned by DampingFactor(dt, halflife)
+        {
+            Dampen(damp);
+            CalcForces(currBallList);
+            Extrapolate(dt/2);
+            CalcForces(nextBallList);
+            Extrapolate(dt);
+            std::swap(nextBallList, currBallList);
+        }
+    };
+}
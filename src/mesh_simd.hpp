@@ -0,0 +1,116 @@
+#pragma once
+#include <vector>
+#include "mesh_physics.hpp"
+
+// Sapphire mesh physics engine, by Don Cross <cosinekitty@gmail.com>
+// https://github.com/cosinekitty/sapphire
+
+namespace Sapphire
+{
+    // SimdMesh describes a mesh topology in the slot layout that PolySimdMesh simulates.
+    // Mobile balls come first, padded to a multiple of 4 slots, followed by the anchors.
+    // meshgen generates ElastikaSimdMesh from the same description as ElastikaMesh,
+    // adding springs in the same order as the unrolled code.
+
+    class SimdMesh
+    {
+    private:
+        const int nballs;       // number of real balls, both mobile and anchor
+        const int nmobile;      // number of mobile balls, which must be the first balls added
+        const int mobileSlots;  // nmobile rounded up to a multiple of 4
+        int addedBalls = 0;
+
+        std::vector<float> ox, oy, oz;      // original ball positions [m]
+        std::vector<float> mass;            // ball masses [kg]
+        std::vector<int> springA;           // slot index of the first ball in each spring
+        std::vector<int> springB;           // slot index of the second ball in each spring
+
+        float stiffness  = MESH_DEFAULT_STIFFNESS;
+        float restLength = MESH_DEFAULT_REST_LENGTH;
+        float speedLimit = MESH_DEFAULT_SPEED_LIMIT;
+
+        int slot(int ballIndex) const
+        {
+            // Mobile balls keep their index. Anchors are shifted past the padding slots.
+            if (ballIndex < 0 || ballIndex >= nballs)
+                throw std::out_of_range("SimdMesh ball index");
+            return (ballIndex < nmobile) ? ballIndex : (ballIndex + (mobileSlots - nmobile));
+        }
+
+    protected:
+        SimdMesh(int totalBallCount, int mobileBallCount)
+            : nballs(totalBallCount)
+            , nmobile(mobileBallCount)
+            , mobileSlots((mobileBallCount + 3) & ~3)
+        {
+            const std::size_t nslots = static_cast<std::size_t>(NumSlots());
+            ox.resize(nslots);
+            oy.resize(nslots);
+            oz.resize(nslots);
+            mass.resize(nslots, 1.0f);      // padding slots have nonzero mass to avoid dividing by zero
+        }
+
+        void AddBall(float _mass, float _x, float _y, float _z)
+        {
+            if (addedBalls >= nballs)
+                throw std::logic_error("SimdMesh has too many balls.");
+
+            if ((addedBalls < nmobile) != (_mass > 0.0f))
+                throw std::logic_error("SimdMesh requires mobile balls to be added before anchors.");
+
+            const int i = slot(addedBalls++);
+            mass[i] = _mass;
+            ox[i] = _x;
+            oy[i] = _y;
+            oz[i] = _z;
+        }
+
+        void AddSpring(int ballIndex1, int ballIndex2)
+        {
+            const int a = slot(ballIndex1);
+            const int b = slot(ballIndex2);
+            if (a >= nmobile && b >= nmobile)
+                throw std::logic_error("SimdMesh cannot connect a spring between two anchors.");
+            springA.push_back(a);
+            springB.push_back(b);
+        }
+
+    public:
+        static float DampingFactor(float dt, float halflife)
+        {
+            return OneHalfToPower(dt/halflife);
+        }
+
+        int NumBalls() const { return nballs; }
+        float GetStiffness() const { return stiffness; }
+        void SetStiffness(float _stiffness) { stiffness = std::max(0.0f, _stiffness); }
+        float GetRestLength() const { return restLength; }
+        void SetRestLength(float _restLength) { restLength = std::max(0.0f, _restLength); }
+        float GetSpeedLimit() const { return speedLimit; }
+        void SetSpeedLimit(float _speedLimit) { speedLimit = _speedLimit; }
+
+        PhysicsVector GetBallOrigin(int index) const
+        {
+            const int i = slot(index);
+            return PhysicsVector(ox[i], oy[i], oz[i], 0.0f);
+        }
+
+        // Read-only access to the slot layout.
+        int NumSlots() const { return nballs + (mobileSlots - nmobile); }
+        int NumMobileSlots() const { return mobileSlots; }
+        int NumSprings() const { return static_cast<int>(springA.size()); }
+        int SpringSlotA(int spring) const { return springA.at(spring); }
+        int SpringSlotB(int spring) const { return springB.at(spring); }
+        int BallSlot(int ballIndex) const { return slot(ballIndex); }
+        float SlotMass(int s) const { return mass.at(s); }
+        PhysicsVector SlotOrigin(int s) const { return PhysicsVector(ox.at(s), oy.at(s), oz.at(s), 0.0f); }
+
+        void SetBallMass(int index, float _mass)
+        {
+            const int i = slot(index);
+            if ((i < nmobile) != (_mass > 0.0f))
+                throw std::logic_error("SimdMesh cannot convert between mobile balls and anchors.");
+            mass[i] = _mass;
+        }
+    };
+}
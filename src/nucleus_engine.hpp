@@ -6,6 +6,7 @@
 
 #pragma once
 #include <algorithm>
+#include <limits>
 #include "sapphire_engine.hpp"
 
 namespace Sapphire
@@ -36,6 +37,429 @@ namespace Sapphire
     };
 
 
+    // NucleusForceKernel calculates the exact forces between every pair of particles.
+    // Effective velocities are calculated once per particle, not once per pair.
+    // Positions and velocities are copied into structure-of-arrays scratch buffers,
+    // so that each particle `a` can be paired with 4 particles `b` at a time.
+    // Each lane performs the same floating point operations, in the same order,
+    // as the original scalar loop, so the resulting forces are bit-identical.
+
+    class NucleusForceKernel
+    {
+    private:
+        std::vector<float> px, py, pz;      // positions
+        std::vector<float> vx, vy, vz;      // effective velocities
+        std::vector<float> fx, fy, fz;      // net forces
+
+        void resize(int n)
+        {
+            // Pad by 3 extra slots so the last group of 4 never reads past the end.
+            // The padding positions are NAN, so the overlap test always rejects them.
+            const std::size_t size = n + 3;
+            const float nan = std::numeric_limits<float>::quiet_NaN();
+            for (std::vector<float>* vec : {&px, &py, &pz})
+                vec->assign(size, nan);
+            for (std::vector<float>* vec : {&vx, &vy, &vz, &fx, &fy, &fz})
+                vec->assign(size, 0.0f);
+        }
+
+    public:
+        void calculateForces(
+            std::vector<Particle>& array,
+            float magneticCoupling,
+            float speedLimit,
+            float overlapDistance)
+        {
+            const int n = static_cast<int>(array.size());
+            if (px.size() != static_cast<std::size_t>(n + 3))
+                resize(n);
+
+            for (int i = 0; i < n; ++i)
+            {
+                const Particle& p = array[i];
+                PhysicsVector v = EffectiveVelocity(p.vel, speedLimit);
+                px[i] = p.pos[0];
+                py[i] = p.pos[1];
+                pz[i] = p.pos[2];
+                vx[i] = v[0];
+                vy[i] = v[1];
+                vz[i] = v[2];
+                fx[i] = fy[i] = fz[i] = 0;
+            }
+
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 mc = _mm_set1_ps(magneticCoupling);
+            const __m128 overlap2 = _mm_set1_ps(overlapDistance * overlapDistance);
+
+            for (int i = 0; i+1 < n; ++i)
+            {
+                const __m128 ax = _mm_set1_ps(px[i]);
+                const __m128 ay = _mm_set1_ps(py[i]);
+                const __m128 az = _mm_set1_ps(pz[i]);
+                const __m128 avx = _mm_set1_ps(vx[i]);
+                const __m128 avy = _mm_set1_ps(vy[i]);
+                const __m128 avz = _mm_set1_ps(vz[i]);
+                float afx = fx[i];
+                float afy = fy[i];
+                float afz = fz[i];
+
+                for (int j = i+1; j < n; j += 4)
+                {
+                    const __m128 dx = _mm_sub_ps(_mm_loadu_ps(&px[j]), ax);
+                    const __m128 dy = _mm_sub_ps(_mm_loadu_ps(&py[j]), ay);
+                    const __m128 dz = _mm_sub_ps(_mm_loadu_ps(&pz[j]), az);
+                    const __m128 dist2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+                    // Overlapping particles exert no force on each other. So do the NAN padding slots.
+                    const __m128 mask = _mm_cmpgt_ps(dist2, overlap2);
+                    const int bits = _mm_movemask_ps(mask);
+                    if (bits == 0)
+                        continue;
+
+                    const __m128 dist = _mm_sqrt_ps(dist2);
+                    const __m128 dist3 = _mm_mul_ps(dist2, dist);
+                    const __m128 radial = _mm_sub_ps(dist, _mm_div_ps(one, dist3));
+                    const __m128 magnetic = _mm_div_ps(mc, dist3);
+
+                    const __m128 dvx = _mm_sub_ps(_mm_loadu_ps(&vx[j]), avx);
+                    const __m128 dvy = _mm_sub_ps(_mm_loadu_ps(&vy[j]), avy);
+                    const __m128 dvz = _mm_sub_ps(_mm_loadu_ps(&vz[j]), avz);
+                    const __m128 cx = _mm_sub_ps(_mm_mul_ps(dvy, dz), _mm_mul_ps(dvz, dy));
+                    const __m128 cy = _mm_sub_ps(_mm_mul_ps(dvz, dx), _mm_mul_ps(dvx, dz));
+                    const __m128 cz = _mm_sub_ps(_mm_mul_ps(dvx, dy), _mm_mul_ps(dvy, dx));
+
+                    const __m128 fxj = _mm_and_ps(mask, _mm_add_ps(_mm_mul_ps(radial, dx), _mm_mul_ps(magnetic, cx)));
+                    const __m128 fyj = _mm_and_ps(mask, _mm_add_ps(_mm_mul_ps(radial, dy), _mm_mul_ps(magnetic, cy)));
+                    const __m128 fzj = _mm_and_ps(mask, _mm_add_ps(_mm_mul_ps(radial, dz), _mm_mul_ps(magnetic, cz)));
+
+                    // Forces always act in equal and opposite pairs.
+                    _mm_storeu_ps(&fx[j], _mm_sub_ps(_mm_loadu_ps(&fx[j]), fxj));
+                    _mm_storeu_ps(&fy[j], _mm_sub_ps(_mm_loadu_ps(&fy[j]), fyj));
+                    _mm_storeu_ps(&fz[j], _mm_sub_ps(_mm_loadu_ps(&fz[j]), fzj));
+
+                    // Add the lanes to particle `a` one at a time, in the same order as the scalar loop.
+                    PhysicsVector tx(fxj), ty(fyj), tz(fzj);
+                    for (int k = 0; k < 4; ++k)
+                    {
+                        if (bits & (1 << k))
+                        {
+                            afx += tx[k];
+                            afy += ty[k];
+                            afz += tz[k];
+                        }
+                    }
+                }
+
+                fx[i] = afx;
+                fy[i] = afy;
+                fz[i] = afz;
+            }
+
+            for (int i = 0; i < n; ++i)
+                array[i].force = PhysicsVector(fx[i], fy[i], fz[i], 0);
+        }
+    };
+
+
+    // NucleusOctree approximates the forces between a large number of particles
+    // using the Barnes-Hut algorithm, in O(N log N) time instead of O(N^2).
+    // A cube of particles whose width is less than `theta` times its distance
+    // from a particle is treated as a lump located at the cube's centroid.
+    //
+    // NucleusEngine applies the magnetic force between particles a, b (with a < b)
+    // as an equal and opposite pair, so its direction depends on which particle
+    // has the lower index. To reproduce that, each cube also keeps prefix sums
+    // over its particles in index order, so the magnetic force from particles
+    // with lower and higher indices can be lumped separately.
+
+    class NucleusOctree
+    {
+    private:
+        static const int LeafSize = 8;      // nodes with this many particles or fewer are not split
+        static const int MaxDepth = 20;     // prevents endless splitting of coincident (or non-finite) particles
+
+        struct Node
+        {
+            PhysicsVector center;           // geometric center of the cube
+            float halfWidth = 0;
+            int begin = 0;                  // particles are order[begin] .. order[end-1]
+            int end = 0;
+            int firstChild = -1;            // children are contiguous: nodes[firstChild] .. nodes[firstChild+nchildren-1]
+            int nchildren = 0;
+
+            // The remaining fields are only used for nodes that have children.
+            PhysicsVector centroid;         // mean position of the particles inside the cube
+            PhysicsVector quadDiag;         // second moments about the centroid: sum of (dx*dx, dy*dy, dz*dz)
+            PhysicsVector quadCross;        // second moments about the centroid: sum of (dy*dz, dz*dx, dx*dy)
+            int prefixOffset = 0;           // index into `sorted`, `prefixPos`, `prefixVel`
+            int lowerCount = 0;             // how many particles in this cube have an index below the current particle
+
+            bool contains(const PhysicsVector& pos) const
+            {
+                return
+                    std::abs(pos[0] - center[0]) <= halfWidth &&
+                    std::abs(pos[1] - center[1]) <= halfWidth &&
+                    std::abs(pos[2] - center[2]) <= halfWidth;
+            }
+        };
+
+        std::vector<Node> nodes;
+        std::vector<int> order;
+        std::vector<int> scratch;
+        std::vector<int> stack;
+        std::vector<PhysicsVector> effVel;
+        std::vector<int> sorted;                    // for each split node: its particle indices in ascending order
+        std::vector<PhysicsVector> prefixPos;       // for each split node: count+1 running sums of positions, in index order
+        std::vector<PhysicsVector> prefixVel;       // for each split node: count+1 running sums of effective velocities, in index order
+
+        static int octant(const PhysicsVector& pos, const PhysicsVector& center)
+        {
+            return
+                (pos[0] >= center[0] ? 1 : 0) |
+                (pos[1] >= center[1] ? 2 : 0) |
+                (pos[2] >= center[2] ? 4 : 0);
+        }
+
+        void build(const std::vector<Particle>& array)
+        {
+            const int n = static_cast<int>(array.size());
+            order.resize(n);
+            scratch.resize(n);
+            stack.resize(7*MaxDepth + 8);
+            for (int i = 0; i < n; ++i)
+                order[i] = i;
+
+            PhysicsVector lo = array[0].pos;
+            PhysicsVector hi = array[0].pos;
+            for (const Particle& p : array)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    lo[k] = std::min(lo[k], p.pos[k]);
+                    hi[k] = std::max(hi[k], p.pos[k]);
+                }
+            }
+
+            Node root;
+            root.center = (lo + hi) / 2;
+            root.halfWidth = std::max({hi[0]-lo[0], hi[1]-lo[1], hi[2]-lo[2]}) / 2;
+            root.end = n;
+
+            nodes.clear();
+            sorted.clear();
+            prefixPos.clear();
+            prefixVel.clear();
+            nodes.push_back(root);
+            split(array, 0, 0);
+        }
+
+        void split(const std::vector<Particle>& array, int nodeIndex, int depth)
+        {
+            // Careful: `nodes` can be reallocated below, so copy what we need from this node.
+            const int begin = nodes[nodeIndex].begin;
+            const int end = nodes[nodeIndex].end;
+            const int count = end - begin;
+            const PhysicsVector center = nodes[nodeIndex].center;
+            const float childHalfWidth = nodes[nodeIndex].halfWidth / 2;
+
+            if (count <= LeafSize || depth >= MaxDepth)
+                return;
+
+            // The octant sort below is stable, and the root starts in index order,
+            // so this node's particles are still in ascending index order.
+            const int offset = static_cast<int>(prefixPos.size());
+            PhysicsVector posSum = PhysicsVector::zero();
+            PhysicsVector velSum = PhysicsVector::zero();
+            prefixPos.push_back(posSum);
+            prefixVel.push_back(velSum);
+            for (int k = begin; k < end; ++k)
+            {
+                sorted.push_back(order[k]);
+                posSum += array[order[k]].pos;
+                velSum += effVel[order[k]];
+                prefixPos.push_back(posSum);
+                prefixVel.push_back(velSum);
+            }
+            sorted.push_back(-1);   // keeps `sorted` aligned with the prefix arrays
+
+            const PhysicsVector centroid = posSum / count;
+            PhysicsVector quadDiag = PhysicsVector::zero();
+            PhysicsVector quadCross = PhysicsVector::zero();
+            for (int k = begin; k < end; ++k)
+            {
+                PhysicsVector d = array[order[k]].pos - centroid;
+                quadDiag += d * d;
+                quadCross += PhysicsVector(d[1]*d[2], d[2]*d[0], d[0]*d[1], 0);
+            }
+
+            nodes[nodeIndex].centroid = centroid;
+            nodes[nodeIndex].quadDiag = quadDiag;
+            nodes[nodeIndex].quadCross = quadCross;
+            nodes[nodeIndex].prefixOffset = offset;
+
+            // Sort this node's particles by octant.
+            int start[9] {};
+            for (int k = begin; k < end; ++k)
+                ++start[1 + octant(array[order[k]].pos, center)];
+
+            for (int o = 0; o < 8; ++o)
+                start[o+1] += start[o];
+
+            int fill[8];
+            for (int o = 0; o < 8; ++o)
+                fill[o] = begin + start[o];
+
+            for (int k = begin; k < end; ++k)
+                scratch[fill[octant(array[order[k]].pos, center)]++] = order[k];
+
+            for (int k = begin; k < end; ++k)
+                order[k] = scratch[k];
+
+            // Create a child node for each non-empty octant.
+            const int firstChild = static_cast<int>(nodes.size());
+            for (int o = 0; o < 8; ++o)
+            {
+                if (start[o+1] > start[o])
+                {
+                    Node child;
+                    child.center = center + childHalfWidth * PhysicsVector(
+                        (o & 1) ? +1.0f : -1.0f,
+                        (o & 2) ? +1.0f : -1.0f,
+                        (o & 4) ? +1.0f : -1.0f,
+                        0.0f
+                    );
+                    child.halfWidth = childHalfWidth;
+                    child.begin = begin + start[o];
+                    child.end = begin + start[o+1];
+                    nodes.push_back(child);
+                }
+            }
+
+            const int nchildren = static_cast<int>(nodes.size()) - firstChild;
+            nodes[nodeIndex].firstChild = firstChild;
+            nodes[nodeIndex].nchildren = nchildren;
+
+            for (int c = 0; c < nchildren; ++c)
+                split(array, firstChild + c, depth + 1);
+        }
+
+    public:
+        void calculateForces(
+            std::vector<Particle>& array,
+            float theta,
+            float magneticCoupling,
+            float speedLimit,
+            float overlapDistance)
+        {
+            const int n = static_cast<int>(array.size());
+            if (n == 0)
+                return;
+
+            effVel.resize(n);
+            for (int i = 0; i < n; ++i)
+                effVel[i] = EffectiveVelocity(array[i].vel, speedLimit);
+
+            build(array);
+
+            const float theta2 = theta * theta;
+            const float overlap2 = overlapDistance * overlapDistance;
+
+            // Visit particles in ascending index order, so each node's `lowerCount` only moves forward.
+            for (int i = 0; i < n; ++i)
+            {
+                const PhysicsVector pos = array[i].pos;
+                const PhysicsVector av = effVel[i];
+                PhysicsVector force = PhysicsVector::zero();
+
+                int depth = 0;
+                stack[depth++] = 0;
+                while (depth > 0)
+                {
+                    Node& node = nodes[stack[--depth]];
+                    if (node.firstChild < 0)
+                    {
+                        // Leaf node: add the exact force from each particle.
+                        for (int k = node.begin; k < node.end; ++k)
+                        {
+                            const int j = order[k];
+                            if (j == i)
+                                continue;
+
+                            PhysicsVector dr = array[j].pos - pos;
+                            float dist2 = Quadrature(dr);
+                            if (dist2 > overlap2)
+                            {
+                                float dist = std::sqrt(dist2);
+                                float dist3 = dist2 * dist;
+                                float mc = (j > i) ? magneticCoupling : -magneticCoupling;
+                                force += (dist - 1/dist3)*dr + (mc / dist3)*Cross(effVel[j] - av, dr);
+                            }
+                        }
+                        continue;
+                    }
+
+                    PhysicsVector dr = node.centroid - pos;
+                    float dist2 = Quadrature(dr);
+                    float width = 2 * node.halfWidth;
+                    if (width*width < theta2*dist2 && !node.contains(pos))
+                    {
+                        // The cube is far enough away to treat its particles as lumps.
+                        const int count = node.end - node.begin;
+                        const int offset = node.prefixOffset;
+                        int& lower = node.lowerCount;
+                        while (lower < count && sorted[offset + lower] < i)
+                            ++lower;
+
+                        // Attraction/repulsion with a quadrupole correction, because the attraction grows with distance:
+                        // add the sum of (1/2) d^T H d, where H is the Hessian of |r|r and d is each offset from the centroid.
+                        float dist = std::sqrt(dist2);
+                        float dist3 = dist2 * dist;
+                        force += (count * (dist - 1/dist3))*dr;
+
+                        const PhysicsVector& qd = node.quadDiag;
+                        const PhysicsVector& qc = node.quadCross;
+                        PhysicsVector qr(
+                            qd[0]*dr[0] + qc[2]*dr[1] + qc[1]*dr[2],
+                            qc[2]*dr[0] + qd[1]*dr[1] + qc[0]*dr[2],
+                            qc[1]*dr[0] + qc[0]*dr[1] + qd[2]*dr[2],
+                            0
+                        );
+                        float trace = qd[0] + qd[1] + qd[2];
+                        float rqr = Dot(dr, qr) / dist2;
+                        force += (0.5f / dist) * ((trace - rqr)*dr + 2*qr);
+
+                        // Magnetic force: particles with higher indices push one way, lower indices the other.
+                        const PhysicsVector& lowerPos = prefixPos[offset + lower];
+                        const PhysicsVector& lowerVel = prefixVel[offset + lower];
+                        const PhysicsVector upperPos = prefixPos[offset + count] - lowerPos;
+                        const PhysicsVector upperVel = prefixVel[offset + count] - lowerVel;
+                        if (lower > 0)
+                        {
+                            PhysicsVector r = lowerPos/lower - pos;
+                            float r2 = Quadrature(r);
+                            force -= (magneticCoupling / (r2 * std::sqrt(r2))) * Cross(lowerVel - lower*av, r);
+                        }
+                        if (lower < count)
+                        {
+                            const int upper = count - lower;
+                            PhysicsVector r = upperPos/upper - pos;
+                            float r2 = Quadrature(r);
+                            force += (magneticCoupling / (r2 * std::sqrt(r2))) * Cross(upperVel - upper*av, r);
+                        }
+                    }
+                    else
+                    {
+                        for (int c = 0; c < node.nchildren; ++c)
+                            stack[depth++] = node.firstChild + c;
+                    }
+                }
+
+                array[i].force = force;
+            }
+        }
+    };
+
+
     using NucleusDcRejectFilter = StagedFilter<float, 3>;
     const float DefaultCornerFrequencyHz = 30;
 
@@ -54,6 +478,9 @@ namespace Sapphire
         std::vector<float> outputBuffer;        // allows feeding output data through the Automatic Gain Limiter.
         float aetherSpin = 0;
         float aetherVisc = 0;
+        float barnesHutTheta = 0;               // 0 = exact all-pairs forces, >0 = Barnes-Hut approximation
+        NucleusOctree octree;
+        NucleusForceKernel forceKernel;
 
         // DC reject state (consider moving into a separate class...)
         bool enableDcReject = false;
@@ -68,49 +495,14 @@ namespace Sapphire
             // FIXFIXFIX: include aetherSpin, aetherVisc in the force calculations: a kind of "frame dragging".
 
             const float overlapDistance = 1.0e-4f;
-            const int n = static_cast<int>(numParticles());
 
-            // Reset all forces to zero, preparing to tally them.
-            for (Particle& p : array)
-                p.force = PhysicsVector::zero();
-
-            // Find each pair of distinct particles (a, b).
-            // Add up all the forces acting between the particles.
-            for (int i = 0; i+1 < n; ++i)
+            if (barnesHutTheta > 0)
             {
-                Particle& a = array.at(i);
-                for (int j = i+1; j < n; ++j)
-                {
-                    Particle& b = array.at(j);
-
-                    // Find the mutual force vector between the two vectors.
-                    // This includes an electrostatic component and a magnetic component.
-
-                    // Calculate mutual quadrature = distance squared.
-                    PhysicsVector dr = b.pos - a.pos;
-                    float dist2 = Quadrature(dr);
-
-                    // If two particles are very close to each other, consider them overlapping,
-                    // and consider there to be zero force between them. This prevents division by
-                    // zero (or by very small distances), resulting in destabilizing the simulation.
-                    if (dist2 > overlapDistance * overlapDistance)
-                    {
-                        float dist = std::sqrt(dist2);
-                        float dist3 = dist2 * dist;
-
-                        // Use effective velocities, not raw velocities, to calculate magnetic cross product.
-                        PhysicsVector av = EffectiveVelocity(a.vel, speedLimit);
-                        PhysicsVector bv = EffectiveVelocity(b.vel, speedLimit);
-
-                        // Calculate the magnetic component of the mutual force and include it in the vector sum.
-                        PhysicsVector f = (dist - 1/dist3)*dr + (magneticCoupling / dist3)*Cross(bv - av, dr);
-
-                        // Forces always act in equal and opposite pairs.
-                        a.force += f;
-                        b.force -= f;
-                    }
-                }
+                octree.calculateForces(array, barnesHutTheta, magneticCoupling, speedLimit, overlapDistance);
+                return;
             }
+
+            forceKernel.calculateForces(array, magneticCoupling, speedLimit, overlapDistance);
         }
 
         void extrapolate(float dt)
@@ -119,8 +511,8 @@ namespace Sapphire
 
             for (int i = 0; i < n; ++i)
             {
-                const Particle& p1 = curr.at(i);
-                Particle& p2 = next.at(i);
+                const Particle& p1 = curr[i];
+                Particle& p2 = next[i];
 
                 // F = m*a  ==>  a = F/m.
                 PhysicsVector acc = p1.force / p1.mass;
@@ -303,6 +695,20 @@ namespace Sapphire
             }
         }
 
+        float getBarnesHutTheta() const
+        {
+            return barnesHutTheta;
+        }
+
+        void setBarnesHutTheta(float theta = 0)
+        {
+            // Controls the accuracy of forces between particles.
+            // 0 = calculate every pair of particles exactly, which is best for small numbers of particles.
+            // Larger values trade accuracy for speed, but the exact vectorized kernel
+            // is faster until there are about a thousand particles.
+            barnesHutTheta = std::clamp(theta, 0.0f, 1.0f);
+        }
+
         void setMagneticCoupling(float mc)
         {
             magneticCoupling = mc;
@@ -105,6 +105,7 @@ namespace Sapphire
             double yVoltageScale = 1;
             double zVoltageScale = 1;
             int oversampling = 1;
+            bool adaptiveIntegrator = false;
             bool offerFactoryPresetsOnChaosKnob = false;
 
             ChaosModule()
@@ -146,6 +147,7 @@ namespace Sapphire
                 yVoltageScale = 1;
                 zVoltageScale = 1;
                 oversampling = 1;
+                adaptiveIntegrator = false;
             }
 
             void onReset(const ResetEvent& e) override
@@ -210,6 +212,7 @@ namespace Sapphire
                 jsonSetDouble(root, "zVoltageScale", zVoltageScale);
                 jsonSetInt(root, "oversampling", oversampling);
                 jsonSetBool(root, "turboMode", turboMode);
+                jsonSetBool(root, "adaptiveIntegrator", adaptiveIntegrator);
 
                 // Save the memory cells as a JSON array.
                 json_t* memoryArray = json_array();
@@ -238,6 +241,7 @@ namespace Sapphire
                 oversampling = std::clamp(oversampling, 1, 10);     // self-healing: fix and save range errors
 
                 jsonLoadBool(root, "turboMode", turboMode);
+                jsonLoadBool(root, "adaptiveIntegrator", adaptiveIntegrator);
 
                 json_t* mode = json_object_get(root, "chaosMode");
                 circuit.setMode(
@@ -328,6 +332,7 @@ namespace Sapphire
                     if (turboMode)
                         speed += 5;
                     double dt = args.sampleTime * TwoToPower(speed);
+                    circuit.setIntegrator(adaptiveIntegrator ? ChaosIntegrator::DormandPrince : ChaosIntegrator::RungeKutta4);
                     circuit.update(dt, oversampling);
                 }
 
@@ -577,6 +582,25 @@ namespace Sapphire
         }
 
 
+        template <typename module_t>
+        inline MenuItem* CreateAdaptiveIntegratorMenuItem(module_t* chaosModule)
+        {
+            return createBoolMenuItem(
+                "Adaptive step size (saves CPU)",
+                "",
+                [=]()
+                {
+                    return chaosModule->adaptiveIntegrator;
+                },
+                [=](bool state)
+                {
+                    if (chaosModule->adaptiveIntegrator != state)
+                        InvokeAction(new BoolToggleAction(chaosModule->adaptiveIntegrator, "adaptive step size"));
+                }
+            );
+        }
+
+
         template <typename module_t>
         inline MenuItem* CreateFlashToggleMenuItem(module_t* chaosModule)
         {
@@ -670,6 +694,7 @@ namespace Sapphire
                 // panel, but don't think to do that for knobs.
 
                 menu->addChild(CreateTurboModeMenuItem<module_t>(chaosModule));
+                menu->addChild(CreateAdaptiveIntegratorMenuItem<module_t>(chaosModule));
                 menu->addChild(CreateFlashToggleMenuItem<module_t>(chaosModule));
                 AddChaosOptionsToMenu(menu, chaosModule, false);
             }
@@ -0,0 +1,113 @@
+#pragma once
+#include <array>
+#include <algorithm>
+
+namespace Sapphire
+{
+    // Slow modulation sources (chaotic CV, tape motors) have no useful content
+    // above a few tens of hertz, so they can be calculated once every few samples
+    // and linearly interpolated back to audio rate.
+
+    enum class ControlRate
+    {
+        EverySample,
+        Every4,
+        Every16,
+        Every32,
+        LEN,
+
+        Default = EverySample
+    };
+
+
+    constexpr int ControlRateInterval(ControlRate rate)
+    {
+        switch (rate)
+        {
+        case ControlRate::Every4:   return 4;
+        case ControlRate::Every16:  return 16;
+        case ControlRate::Every32:  return 32;
+        default:                    return 1;
+        }
+    }
+
+
+    template <unsigned nsignals>
+    class ControlRateInterpolator
+    {
+        // Usage, once per audio sample:
+        //     if (ctrl.isDue())
+        //         ctrl.push(<control values for `ctrl.getInterval()` samples from now>);
+        //     const auto& value = ctrl.process();
+        //
+        // The output ramps from where it is toward each pushed value,
+        // arriving exactly on the last sample of the interval.
+        // With an interval of 1, the output is exactly the pushed values.
+
+    public:
+        using value_t = std::array<float, nsignals>;
+
+    private:
+        value_t prev{};
+        value_t next{};
+        value_t current{};
+        int interval = 1;
+        int countdown = 0;
+        bool primed = false;
+
+    public:
+        void initialize()
+        {
+            // The next pushed value takes effect immediately instead of ramping.
+            // Call this when the control source jumps on purpose, e.g. during anti-click silence.
+            countdown = 0;
+            primed = false;
+        }
+
+        int getInterval() const
+        {
+            return interval;
+        }
+
+        void setInterval(int samples)
+        {
+            samples = std::max(1, samples);
+            if (samples != interval)
+            {
+                // Start a new interval from the current output, so there is no discontinuity.
+                interval = samples;
+                countdown = 0;
+            }
+        }
+
+        bool isDue() const
+        {
+            return countdown <= 0;
+        }
+
+        void push(const value_t& value)
+        {
+            prev = primed ? current : value;
+            next = value;
+            primed = true;
+            countdown = interval;
+        }
+
+        const value_t& process()
+        {
+            if (countdown > 1)
+            {
+                --countdown;
+                const float mix = 1 - static_cast<float>(countdown) / interval;
+                for (unsigned i = 0; i < nsignals; ++i)
+                    current[i] = prev[i] + mix*(next[i] - prev[i]);
+            }
+            else
+            {
+                countdown = 0;
+                current = next;
+            }
+            return current;
+        }
+    };
+}
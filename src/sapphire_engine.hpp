@@ -253,6 +253,14 @@ namespace Sapphire
         }
 
         void Reset() { Snap(0); }
+
+        void ResetLane(int lane)
+        {
+            // For vector types that filter independent signals in parallel:
+            // reset only the signal in `lane`.
+            xprev[lane] = yprev[lane] = 0;
+        }
+
         void SetCutoffFrequency(float cutoffFrequencyHz) { fc = cutoffFrequencyHz; }
 
         void Update(value_t x, float sampleRateHz)
@@ -280,6 +288,12 @@ namespace Sapphire
                 stage[i].Reset();
         }
 
+        void ResetLane(int lane)
+        {
+            for (int i = 0; i < LAYERS; ++i)
+                stage[i].ResetLane(lane);
+        }
+
         void SetCutoffFrequency(float cutoffFrequencyHz)
         {
             for (int i = 0; i < LAYERS; ++i)
@@ -552,6 +566,152 @@ namespace Sapphire
         }
     };
 
+    constexpr std::size_t NextPowerOfTwo(std::size_t n)
+    {
+        std::size_t p = 1;
+        while (p < n)
+            p *= 2;
+        return p;
+    }
+
+
+    template <typename item_t>
+    struct DelayLineSpans
+    {
+        // A contiguous range of delay line items that may wrap around the end of the buffer.
+        // Process data[0][0..count[0]-1], then data[1][0..count[1]-1].
+        item_t* data[2]{};
+        std::size_t count[2]{};
+    };
+
+
+    template <typename item_t, std::size_t bufsize = 10000>
+    class Pow2DelayLine
+    {
+        // Same behavior as DelayLine, including the maximum length,
+        // but the buffer is rounded up to a power of two so that positions
+        // wrap around using a bit mask instead of division.
+        // Single-item reads do not check their offsets: they must be less than getMaxLength().
+
+    private:
+        static_assert(bufsize > 1, "The buffer must have room for more than 1 sample.");
+        static constexpr std::size_t capacity = NextPowerOfTwo(bufsize);
+        static constexpr std::size_t mask = capacity - 1;
+
+        std::vector<item_t> buffer;
+        std::size_t front = 1;               // postion where data is inserted
+        std::size_t back = 0;                // postion where data is removed
+
+        void checkBlockSize(std::size_t offset, std::size_t count) const
+        {
+            // Items past the active length are stale, or are about to be overwritten.
+            if (offset + count > getLength())
+                throw std::range_error("Delay line block is out of bounds.");
+        }
+
+        template <typename span_item_t>
+        static DelayLineSpans<span_item_t> makeSpans(span_item_t* base, std::size_t start, std::size_t count)
+        {
+            DelayLineSpans<span_item_t> spans;
+            start &= mask;
+            spans.count[0] = std::min(count, capacity - start);
+            spans.count[1] = count - spans.count[0];
+            spans.data[0] = base + start;
+            spans.data[1] = base;
+            return spans;
+        }
+
+    public:
+        Pow2DelayLine()
+        {
+            buffer.resize(capacity);
+        }
+
+        item_t readForward(std::size_t offset) const
+        {
+            // Access an item at an integer offset toward the future from the back of the delay line.
+            return buffer[(back + offset) & mask];
+        }
+
+        item_t readBackward(std::size_t offset) const
+        {
+            // Access an item at an integer offset into the past from the front of the delay line.
+            return buffer[(front - (offset + 1)) & mask];
+        }
+
+        void write(const item_t& x)
+        {
+            buffer[front] = x;
+            front = (front + 1) & mask;
+            back = (back + 1) & mask;
+        }
+
+        std::size_t getMaxLength() const
+        {
+            return bufsize - 1;
+        }
+
+        std::size_t getLength() const
+        {
+            return (front - back) & mask;
+        }
+
+        std::size_t setLength(std::size_t requestedSamples)
+        {
+            std::size_t nsamples = std::clamp<std::size_t>(requestedSamples, 1, getMaxLength());
+            back = (front - nsamples) & mask;
+            assert(nsamples == getLength());
+            return nsamples;
+        }
+
+        void clear()
+        {
+            for (item_t& x : buffer)
+                x = {};
+        }
+
+        // Block operations.
+        // For a block of `count` <= getLength() items, calling readBlock(0, ...) and then writeBlock(...)
+        // is equivalent to alternating readForward(0) and write() `count` times.
+
+        DelayLineSpans<const item_t> readSpans(std::size_t offset, std::size_t count) const
+        {
+            // The items readForward(offset) .. readForward(offset + count - 1), in order.
+            checkBlockSize(offset, count);
+            return makeSpans<const item_t>(buffer.data(), back + offset, count);
+        }
+
+        DelayLineSpans<item_t> writeSpans(std::size_t count)
+        {
+            // The slots that the next `count` calls to write() would fill.
+            // Fill them in order, then call advance(count).
+            checkBlockSize(0, count);
+            return makeSpans<item_t>(buffer.data(), front, count);
+        }
+
+        void advance(std::size_t count)
+        {
+            front = (front + count) & mask;
+            back = (back + count) & mask;
+        }
+
+        void readBlock(std::size_t offset, item_t* output, std::size_t count) const
+        {
+            const DelayLineSpans<const item_t> spans = readSpans(offset, count);
+            std::copy(spans.data[0], spans.data[0] + spans.count[0], output);
+            std::copy(spans.data[1], spans.data[1] + spans.count[1], output + spans.count[0]);
+        }
+
+        void writeBlock(const item_t* input, std::size_t count)
+        {
+            const DelayLineSpans<item_t> spans = writeSpans(count);
+            std::copy(input, input + spans.count[0], spans.data[0]);
+            std::copy(input + spans.count[0], input + count, spans.data[1]);
+            advance(count);
+        }
+    };
+
+
     inline float Sinc(float x)
     {
         float angle = std::abs(static_cast<float>(M_PI * x));
@@ -681,10 +841,26 @@ namespace Sapphire
     {
     private:
         static const InterpolatorTable table;
+
+    public:
         static const std::size_t nsamples = 1 + 2*steps;
+
+    private:
         item_t buffer[nsamples] {};
 
     public:
+        static void window(float position, float weights[nsamples])
+        {
+            // Calculates the weights that read(position) multiplies with the buffered samples, in the same order.
+            // Callers that read many times at the same position can cache these.
+            if (position < -1.0f || position > +1.0f)
+                throw std::range_error("Interpolator read position is out of bounds.");
+
+            const int s = static_cast<int>(steps);
+            for (int n = -s; n <= s; ++n)
+                weights[n+s] = table.Taper(position - n);
+        }
+
         void write(int position, item_t value)
         {
             std::size_t index = static_cast<std::size_t>(static_cast<int>(steps) + position);
@@ -710,6 +886,130 @@ namespace Sapphire
     template <typename item_t, std::size_t steps>
     const InterpolatorTable Interpolator<item_t, steps>::table {steps, 0x801};
 
+
+    class PolyphaseTable
+    {
+        // A filter bank of tapered sinc coefficients for PolyphaseInterpolator.
+        // The read position range [-1, +1] is divided into 2*nphases intervals.
+        // Each interval has a row of quadratic polynomial coefficients for every tap,
+        // so the weights for any position in the interval are  c0 + t*(c1 + t*c2),  where t is in [0, 1].
+        // That is as accurate as InterpolatorTable::Taper, but needs no per-tap branching or table lookups.
+
+    private:
+        const std::size_t steps;
+        const std::size_t nphases;      // number of intervals per unit distance
+        const std::size_t stride;       // number of taps, rounded up to a multiple of 4
+        std::vector<float> coeff;       // [interval][polynomial term][tap]
+
+    public:
+        PolyphaseTable(std::size_t _steps, std::size_t _nphases)
+            : steps(_steps)
+            , nphases(_nphases)
+            , stride((2*_steps + 4) & ~std::size_t{3})
+        {
+            const std::size_t nrows = 2*nphases;
+            coeff.resize(3 * nrows * stride);
+            const int s = static_cast<int>(steps);
+            for (std::size_t row = 0; row < nrows; ++row)
+            {
+                float *c = &coeff[3 * row * stride];
+                for (int n = -s; n <= s; ++n)
+                {
+                    // Fit a parabola through the taper values at the start, middle, and end of the interval.
+                    // Calculate the taper in double precision, so the only significant error is float rounding.
+                    auto taper = [=](double t)
+                    {
+                        double x = (row + t)/nphases - 1.0 - n;
+                        double angle = M_PI * x;
+                        double sinc = (std::abs(angle) < 1.0e-12) ? 1.0 : std::sin(angle) / angle;
+                        double blackman = (x + (steps+1)) / (2*(steps+1));
+                        return sinc * (0.42 - 0.5*std::cos(2*M_PI*blackman) + 0.08*std::cos(4*M_PI*blackman));
+                    };
+                    const double y0 = taper(0.0);
+                    const double ym = taper(0.5);
+                    const double y1 = taper(1.0);
+                    c[n+s]          = static_cast<float>(y0);
+                    c[n+s+stride]   = static_cast<float>(4*ym - 3*y0 - y1);
+                    c[n+s+2*stride] = static_cast<float>(2*(y0 + y1) - 4*ym);
+                }
+            }
+        }
+
+        std::size_t getStride() const
+        {
+            return stride;
+        }
+
+        void weights(float position, float *w) const
+        {
+            // Calculate `stride` weights for the taps, given a position in the range [-1, +1].
+            // Any padding weights beyond the last tap are zero.
+            const float u = (position + 1.0f) * nphases;
+            const std::size_t row = std::min(static_cast<std::size_t>(u), 2*nphases - 1);
+            const float t = u - row;
+            const float *c = &coeff[3 * row * stride];
+            for (std::size_t i = 0; i < stride; ++i)
+                w[i] = c[i] + t*(c[i+stride] + t*c[i+2*stride]);
+        }
+    };
+
+
+    template <typename item_t, std::size_t steps>
+    class PolyphaseInterpolator
+    {
+        // A drop-in replacement for Interpolator that uses a precomputed PolyphaseTable.
+        // Each read is a weight calculation plus a dot product, both of which vectorize.
+
+    private:
+        static const PolyphaseTable table;
+        static const std::size_t nsamples = 1 + 2*steps;
+        static const std::size_t stride = (nsamples + 3) & ~std::size_t{3};
+        item_t buffer[stride] {};       // padding items stay zero
+
+    public:
+        void write(int position, item_t value)
+        {
+            std::size_t index = static_cast<std::size_t>(static_cast<int>(steps) + position);
+            if (index >= nsamples)
+                throw std::range_error("Interpolator write position is out of bounds.");
+            buffer[index] = value;
+        }
+
+        item_t read(float position) const
+        {
+            if (position < -1.0f || position > +1.0f)
+                throw std::range_error("Interpolator read position is out of bounds.");
+
+            float w[stride];
+            table.weights(position, w);
+            return PolyphaseDot(buffer, w);
+        }
+
+    private:
+        template <typename value_t>
+        static value_t PolyphaseDot(const value_t *x, const float *w)
+        {
+            value_t sum {};
+            for (std::size_t i = 0; i < nsamples; ++i)
+                sum += x[i] * w[i];
+            return sum;
+        }
+
+        static float PolyphaseDot(const float *x, const float *w)
+        {
+            // Include the zero padding, so the whole buffer is processed 4 floats at a time.
+            __m128 sum = _mm_setzero_ps();
+            for (std::size_t i = 0; i < stride; i += 4)
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(w + i)));
+            float s[4];
+            _mm_storeu_ps(s, sum);
+            return (s[0] + s[1]) + (s[2] + s[3]);
+        }
+    };
+
+    template <typename item_t, std::size_t steps>
+    const PolyphaseTable PolyphaseInterpolator<item_t, steps>::table {steps, 0x100};
+
     //-----------------------------------------------------------------------------------------
 
 
@@ -807,6 +1107,153 @@ namespace Sapphire
         }
     };
 
+
+    enum class FilterTanMode
+    {
+        Exact,      // std::tan for each channel: bit-identical to StateVariableFilter<float>
+        Fast,       // FastTanPi for 4 channels at once: much cheaper under audio-rate modulation
+        LEN,
+
+        Default = Exact
+    };
+
+
+    inline PhysicsVector FastTanPi(const PhysicsVector& x)
+    {
+        // Calculates tan(pi*x) in each lane, for 0 <= x < 0.5.
+        // Uses the [5/4] Pade approximant of tan(u) for 0 <= u <= pi/4,
+        // and tan(u) = 1/tan(pi/2 - u) above that.
+        // The relative error is less than 3.0e-7 (about 3 float ulps) over the whole range,
+        // verified by the 'fasttan' unit test.
+        const __m128 quarter = _mm_set1_ps(0.25f);
+        const __m128 flip = _mm_cmpgt_ps(x.v, quarter);
+        const __m128 y = _mm_or_ps(_mm_and_ps(flip, _mm_sub_ps(_mm_set1_ps(0.5f), x.v)), _mm_andnot_ps(flip, x.v));
+        const PhysicsVector u = static_cast<float>(M_PI) * PhysicsVector(y);
+        const PhysicsVector u2 = u * u;
+        const PhysicsVector num = u * (945 + u2*(-105 + u2));
+        const PhysicsVector den = 945 + u2*(-420 + 15*u2);
+        return PhysicsVector(_mm_or_ps(
+            _mm_and_ps(flip, _mm_div_ps(den.v, num.v)),
+            _mm_andnot_ps(flip, _mm_div_ps(num.v, den.v))
+        ));
+    }
+
+
+    class QuadStateVariableFilter
+    {
+        // Four independent state variable filters, one per SIMD lane,
+        // each with its own corner frequency and resonance.
+        // With FilterTanMode::Exact, every lane produces exactly the same output as StateVariableFilter<float>.
+        // With FilterTanMode::Fast, all 4 lanes update their coefficients together using FastTanPi.
+
+    private:
+        PhysicsVector c1{};
+        PhysicsVector c2{};
+        PhysicsVector a1{};
+        PhysicsVector a2{};
+        PhysicsVector a3{};
+        PhysicsVector k{};
+
+        PhysicsVector prevFreqRatio{};
+        PhysicsVector prevResonance{};
+        FilterTanMode tanMode = FilterTanMode::Default;
+
+        static constexpr float cushion = 0.002;    // values of `k` too close to zero cause excessive ringing and aliasing
+
+        void updateExact(const PhysicsVector& ratio, const PhysicsVector& resonance)
+        {
+            for (int i = 0; i < 4; ++i)
+            {
+                if (ratio[i] != prevFreqRatio[i] || resonance[i] != prevResonance[i])
+                {
+                    prevFreqRatio[i] = ratio[i];
+                    prevResonance[i] = resonance[i];
+
+                    if (i > 0 && ratio[i] == ratio[i-1] && resonance[i] == resonance[i-1])
+                    {
+                        // Lanes often share settings: reuse the previous lane's coefficients.
+                        k[i] = k[i-1];
+                        a1[i] = a1[i-1];
+                        a2[i] = a2[i-1];
+                        a3[i] = a3[i-1];
+                    }
+                    else
+                    {
+                        float g = std::tan(M_PI * ratio[i]);
+                        k[i] = cushion + ((2-cushion) * Cube(1-resonance[i]));
+                        a1[i] = 1 / (1 + g*(g + k[i]));
+                        a2[i] = g * a1[i];
+                        a3[i] = g * a2[i];
+                    }
+                }
+            }
+        }
+
+        void updateFast(const PhysicsVector& ratio, const PhysicsVector& resonance)
+        {
+            const __m128 changed = _mm_or_ps(
+                _mm_cmpneq_ps(ratio.v, prevFreqRatio.v),
+                _mm_cmpneq_ps(resonance.v, prevResonance.v)
+            );
+            if (_mm_movemask_ps(changed) == 0)
+                return;
+
+            prevFreqRatio = ratio;
+            prevResonance = resonance;
+
+            // Keep the tangent finite at and beyond the Nyquist frequency.
+            const PhysicsVector g = FastTanPi(PhysicsVector(_mm_min_ps(ratio.v, _mm_set1_ps(0.4999f))));
+            const PhysicsVector r = 1 - resonance;
+            k = cushion + ((2-cushion) * (r*r*r));
+            a1 = 1 / (1 + g*(g + k));
+            a2 = g * a1;
+            a3 = g * a2;
+        }
+
+    public:
+        void initialize()
+        {
+            c1 = 0;
+            c2 = 0;
+        }
+
+        void setTanMode(FilterTanMode mode)
+        {
+            if (mode != tanMode)
+            {
+                tanMode = mode;
+                prevFreqRatio = prevResonance = 0;      // recalculate the coefficients with the new method
+                k = a1 = a2 = a3 = 0;
+            }
+        }
+
+        FilterTanMode getTanMode() const
+        {
+            return tanMode;
+        }
+
+        FilterResult<PhysicsVector> process(
+            float sampleRateHz,
+            const PhysicsVector& cornerFreqHz,
+            const PhysicsVector& resonance,
+            const PhysicsVector& input)
+        {
+            const PhysicsVector ratio = cornerFreqHz / sampleRateHz;
+            if (tanMode == FilterTanMode::Fast)
+                updateFast(ratio, resonance);
+            else
+                updateExact(ratio, resonance);
+
+            PhysicsVector v3 = input - c2;
+            PhysicsVector bandpass = a1*c1 + a2*v3;
+            PhysicsVector lowpass = c2 + a2*c1 + a3*v3;
+            c1 = 2*bandpass - c1;
+            c2 = 2*lowpass - c2;
+
+            return FilterResult<PhysicsVector>(lowpass, bandpass, input - k*bandpass - lowpass);
+        }
+    };
+
     //-----------------------------------------------------------------------------------------
 
     struct PanningFactors
@@ -193,6 +193,13 @@ namespace Sapphire
             }
         }
 
+        inline std::string TapeMemoryText(std::size_t bytes)
+        {
+            char text[32];
+            snprintf(text, sizeof(text), "%0.1f MB", bytes / (1024.0 * 1024.0));
+            return text;
+        }
+
         enum class ClockSignalFormat
         {
             Pulses,     // interval between rising edges defines the delay time
@@ -221,6 +228,8 @@ namespace Sapphire
             TapInputRouting inputRouting = TapInputRouting::Default;
             float routingSmooth = 1;    // ducking factor just before/after changing inputRouting
             InterpolatorKind interpolatorKind = InterpolatorKind::Linear;
+            TapeStorage tapeStorage = TapeStorage::Default;
+            ControlRate controlRate = ControlRate::Default;
             bool polyphonic = false;    // selects desired output format: false=stereo(L,R), true=polyphonic(L)
             bool musicalInterval = false;
             float tapeSlewRate = 0.5;
@@ -1,4 +1,9 @@
+#include <map>
+#include <set>
+#include <tuple>
 #include "sapphire_prog_chaos.hpp"
+#include "sapphire_prog_jit.hpp"
+#include "sapphire_simd.hpp"
 
 namespace Sapphire
 {
@@ -30,17 +35,19 @@ namespace Sapphire
         SlopeVector vec;
         try
         {
-            if (prog.outputs.size() == 3)
+            adoptPublishedProgram();
+            BytecodeProgram& run = *running;
+            if (!halted && run.outputs.size() == 3)
             {
-                prog.reg[inputRegister[0]] = x;
-                prog.reg[inputRegister[1]] = y;
-                prog.reg[inputRegister[2]] = z;
+                run.reg[inputRegister[0]] = x;
+                run.reg[inputRegister[1]] = y;
+                run.reg[inputRegister[2]] = z;
 
-                prog.run();
+                run.run();
 
-                vec.mx = prog.reg[prog.outputs[0]];
-                vec.my = prog.reg[prog.outputs[1]];
-                vec.mz = prog.reg[prog.outputs[2]];
+                vec.mx = run.reg[run.outputs[0]];
+                vec.my = run.reg[run.outputs[1]];
+                vec.mz = run.reg[run.outputs[2]];
             }
         }
         catch (const CalcError& ex)
@@ -55,6 +62,63 @@ namespace Sapphire
     }
 
 
+    void ProgOscillator::adoptPublishedProgram() const
+    {
+        // Audio thread: switch to the most recently published program, if there is one.
+        // If the publishing thread has not collected enough retired programs yet,
+        // keep running the current one and try again later.
+        if (pending.load(std::memory_order_relaxed) == nullptr || retired.full())
+            return;
+
+        BytecodeProgram* next = pending.exchange(nullptr, std::memory_order_acq_rel);
+        if (next == nullptr)
+            return;
+
+        // Keep the current knob settings; updateParameters() only runs once per sample.
+        for (int p = 0; p < ParamCount; ++p)
+            next->reg[paramRegister[p]] = running->reg[paramRegister[p]];
+
+        retired.push(running.release());
+        running.reset(next);
+        halted = false;
+    }
+
+
+    void ProgOscillator::recycle(BytecodeProgram* old)
+    {
+        // Keep one block of executable memory for the next publish, and free the rest.
+        if (!spareNative && old->native.use_count() == 1)
+            spareNative = std::move(old->native);
+        delete old;
+    }
+
+
+    void ProgOscillator::publishProgram()
+    {
+        while (BytecodeProgram* old = retired.pop())
+            recycle(old);
+
+        auto next = std::make_unique<BytecodeProgram>(prog);
+        next->prepareNative(std::move(spareNative));
+        spareNative.reset();
+
+        if (BytecodeProgram* unused = pending.exchange(next.release(), std::memory_order_acq_rel))
+            recycle(unused);    // the audio thread never picked it up
+
+        // The audio thread may have retired a program while we were compiling.
+        while (BytecodeProgram* old = retired.pop())
+            recycle(old);
+    }
+
+
+    ProgOscillator::~ProgOscillator()
+    {
+        delete pending.exchange(nullptr);
+        while (BytecodeProgram* old = retired.pop())
+            delete old;
+    }
+
+
     bool BytecodeProgram::isConstantExpression(double& value, const calc_expr_t& expr) const
     {
         if (expr->token.isNumericLiteral())
@@ -317,6 +381,336 @@ namespace Sapphire
     }
 
 
+    class BytecodeOptimizer
+    {
+        // Builds a graph of the values calculated by a bytecode program,
+        // simplifying and sharing them as it goes, so that the program can be
+        // rewritten with only the instructions needed to calculate its outputs.
+        // Every rewrite preserves the exact rounding of the original instructions,
+        // except that a zero result may change sign, and x*0 is assumed to be 0
+        // even though it would be NaN if x were infinite.
+        // This assumes every a*b + c rounds the product before adding, which is what
+        // the native and batch backends do. The interpreter only does the same when the
+        // compiler does not contract it into a fused multiply-add (FMA), so this file
+        // is built with -ffp-contract=off (see Makefile).
+
+    private:
+        struct Value
+        {
+            int reg = -1;               // register holding this value, if known
+            int a = -1;                 // for a calculated value: indexes of the values in a*b + c
+            int b = -1;
+            int c = -1;
+            bool isConstant = false;
+            double constant = 0;
+
+            bool isCalculated() const { return a >= 0; }
+        };
+
+        std::vector<Value> values;
+        std::vector<int> current;                           // value index held by each register at this point in the program
+        std::map<std::tuple<int, int, int>, int> calculated;     // for sharing common subexpressions
+        std::map<double, int> constants;
+
+        bool isConst(int v, double k) const
+        {
+            return values[v].isConstant && values[v].constant == k;
+        }
+
+        bool isProduct(int v) const
+        {
+            return values[v].isCalculated() && isConst(values[v].c, 0);
+        }
+
+        int constantValue(double k)
+        {
+            auto iter = constants.find(k);
+            if (iter != constants.end())
+                return iter->second;
+            Value value;
+            value.isConstant = true;
+            value.constant = BytecodeLiteral::ValidateConstant(k);
+            values.push_back(value);
+            return constants[k] = static_cast<int>(values.size()) - 1;
+        }
+
+        int calculatedValue(int a, int b, int c)
+        {
+            if (b < a)
+                std::swap(a, b);    // multiplication is commutative, even in floating point
+
+            auto key = std::make_tuple(a, b, c);
+            auto iter = calculated.find(key);
+            if (iter != calculated.end())
+                return iter->second;
+            Value value;
+            value.a = a;
+            value.b = b;
+            value.c = c;
+            values.push_back(value);
+            return calculated[key] = static_cast<int>(values.size()) - 1;
+        }
+
+        int simplify(int a, int b, int c)
+        {
+            const Value& va = values[a];
+            const Value& vb = values[b];
+            const Value& vc = values[c];
+
+            if (va.isConstant && vb.isConstant && vc.isConstant)
+                return constantValue(va.constant*vb.constant + vc.constant);
+
+            if (isConst(a, 0) || isConst(b, 0))
+                return c;       // x*0 + c ==> c
+
+            if (va.isConstant && vb.isConstant && !isConst(a, 1) && !isConst(b, 1))
+                return simplify(constantValue(1), constantValue(va.constant*vb.constant), c);
+
+            const int p = isConst(a, 1) ? b : (isConst(b, 1) ? a : -1);
+            if (p >= 0)
+            {
+                if (isConst(c, 0))
+                    return p;   // x*1 + 0 ==> x
+
+                // Fold a separate multiplication into this addition:
+                // 1*(m*n + 0) + c ==> m*n + c
+                // 1*c + (m*n + 0) ==> m*n + c
+                if (isProduct(p))
+                    return calculatedValue(values[p].a, values[p].b, c);
+                if (isProduct(c))
+                    return calculatedValue(values[c].a, values[c].b, p);
+            }
+
+            // Negation is exact, so it can be moved into a constant factor:
+            // (-1)*(k*m + 0) + c ==> (-k)*m + c
+            const int n = isConst(a, -1) ? b : (isConst(b, -1) ? a : -1);
+            if (n >= 0 && isProduct(n))
+            {
+                const Value& vn = values[n];
+                if (values[vn.a].isConstant)
+                    return calculatedValue(constantValue(-values[vn.a].constant), vn.b, c);
+                if (values[vn.b].isConstant)
+                    return calculatedValue(constantValue(-values[vn.b].constant), vn.a, c);
+            }
+
+            return calculatedValue(a, b, c);
+        }
+
+    public:
+        void optimize(BytecodeProgram& prog)
+        {
+            const int nRegisters = static_cast<int>(prog.reg.size());
+
+            // Registers that belong to variables and literals must keep their indexes,
+            // because callers refer to them directly.
+            std::vector<bool> reserved(nRegisters, false);
+            for (int r : prog.registerForSymbol)
+                if (r >= 0)
+                    reserved.at(r) = true;
+            for (const BytecodeLiteral& lit : prog.literals)
+                reserved.at(lit.r) = true;
+
+            // Build the value graph.
+            // Each register starts out holding its own input value.
+            current.resize(nRegisters);
+            for (int r = 0; r < nRegisters; ++r)
+            {
+                Value value;
+                value.reg = r;
+                values.push_back(value);
+                current[r] = r;
+            }
+            for (const BytecodeLiteral& lit : prog.literals)
+            {
+                values[lit.r].isConstant = true;
+                values[lit.r].constant = lit.c;
+                constants[lit.c] = lit.r;
+            }
+
+            for (const BytecodeInstruction& inst : prog.func)
+            {
+                if (reserved.at(inst.r))
+                    return;     // something other than gencode() wrote to a variable or literal; leave the program alone
+
+                current[inst.r] = simplify(current[inst.a], current[inst.b], current[inst.c]);
+            }
+
+            // Find which values are needed to calculate the outputs.
+            const int nValues = static_cast<int>(values.size());
+            std::vector<bool> needed(nValues, false);
+            for (int r : prog.outputs)
+                needed.at(current.at(r)) = true;
+
+            for (int v = nValues-1; v >= 0; --v)
+            {
+                if (needed[v] && values[v].isCalculated())
+                {
+                    needed[values[v].a] = true;
+                    needed[values[v].b] = true;
+                    needed[values[v].c] = true;
+                }
+            }
+
+            // Every needed value that is not calculated lives in a fixed register.
+            // Constants discovered by folding get literal registers of their own.
+            for (int v = 0; v < nValues; ++v)
+            {
+                if (needed[v] && !values[v].isCalculated())
+                {
+                    if (values[v].reg < 0)
+                        values[v].reg = prog.literalRegister(values[v].constant);
+                    reserved.resize(prog.reg.size(), false);
+                    reserved.at(values[v].reg) = true;
+                }
+            }
+
+            // Find where each calculated value is used for the last time.
+            // The outputs must survive until the end of the program.
+            std::vector<int> order;
+            for (int v = 0; v < nValues; ++v)
+                if (needed[v] && values[v].isCalculated())
+                    order.push_back(v);
+
+            const int nInstructions = static_cast<int>(order.size());
+            std::vector<int> lastUse(nValues, -1);
+            for (int i = 0; i < nInstructions; ++i)
+            {
+                const Value& value = values[order[i]];
+                lastUse[value.a] = lastUse[value.b] = lastUse[value.c] = i;
+            }
+            for (int r : prog.outputs)
+                lastUse[current[r]] = nInstructions;
+
+            // Assign registers, reusing a register as soon as the value in it is no longer needed.
+            // An instruction reads all its operands before writing its result,
+            // so the result may go into the register of an operand used for the last time.
+            std::set<int> available;
+            for (int r = 0; r < static_cast<int>(prog.reg.size()); ++r)
+                if (!reserved[r])
+                    available.insert(r);
+
+            BytecodeFunction func;
+            for (int i = 0; i < nInstructions; ++i)
+            {
+                Value& value = values[order[i]];
+                for (int operand : {value.a, value.b, value.c})
+                    if (values[operand].isCalculated() && lastUse[operand] == i)
+                        available.insert(values[operand].reg);
+
+                if (available.empty())
+                {
+                    value.reg = prog.allocateRegister();
+                }
+                else
+                {
+                    value.reg = *available.begin();
+                    available.erase(available.begin());
+                }
+
+                BytecodeInstruction inst;
+                inst.r = value.reg;
+                inst.a = values[value.a].reg;
+                inst.b = values[value.b].reg;
+                inst.c = values[value.c].reg;
+                func.push_back(inst);
+            }
+
+            for (int& r : prog.outputs)
+                r = values[current[r]].reg;
+            prog.func = std::move(func);
+
+            // Release any registers past the highest one still in use.
+            int highest = -1;
+            for (int r = 0; r < static_cast<int>(prog.reg.size()); ++r)
+                if (r < static_cast<int>(reserved.size()) && reserved[r])
+                    highest = r;
+            for (const BytecodeInstruction& inst : prog.func)
+                highest = std::max(highest, static_cast<int>(inst.r));
+            prog.reg.resize(highest + 1);
+        }
+    };
+
+
+    void BytecodeProgram::optimize()
+    {
+        BytecodeOptimizer optimizer;
+        optimizer.optimize(*this);
+    }
+
+
+    BytecodeBatch::BytecodeBatch(const BytecodeProgram& prog, int laneCount)
+    {
+        if (laneCount < 1)
+            throw CalcError("Batch lane count must be positive: " + std::to_string(laneCount));
+
+        nlanes = laneCount;
+        stride = (laneCount + 1) & ~1;
+        load(prog);
+    }
+
+
+    void BytecodeBatch::load(const BytecodeProgram& prog)
+    {
+        const int nRegisters = static_cast<int>(prog.reg.size());
+        storage.resize(static_cast<std::size_t>(nRegisters) * stride);
+        nregisters = nRegisters;
+        for (int r = 0; r < nRegisters; ++r)
+        {
+            double *lane = lanes(r);
+            for (int i = 0; i < stride; ++i)
+                lane[i] = prog.reg[r];
+        }
+    }
+
+
+    void BytecodeProgram::interpret()
+    {
+        for (const BytecodeInstruction& inst : func)
+        {
+            const double product = reg[inst.a] * reg[inst.b];
+            reg[inst.r] = product + reg[inst.c];
+        }
+    }
+
+
+    void BytecodeProgram::runBatch(BytecodeBatch& batch, int nlanes) const
+    {
+        if (nlanes < 0 || nlanes > batch.laneCount())
+            throw CalcError("Batch lane count is out of range: " + std::to_string(nlanes));
+
+        if (batch.registerCount() < static_cast<int>(reg.size()))
+            throw CalcError(
+                "Batch has " + std::to_string(batch.registerCount()) +
+                " registers, but the program needs " + std::to_string(reg.size()) +
+                ". Reload the batch after recompiling.");
+
+        // Each instruction is a separate multiply and add for every lane,
+        // so every lane gets exactly the same answer that run() would calculate.
+        for (const BytecodeInstruction& inst : func)
+        {
+            double *r = batch.lanes(inst.r);
+            const double *a = batch.lanes(inst.a);
+            const double *b = batch.lanes(inst.b);
+            const double *c = batch.lanes(inst.c);
+            for (int i = 0; i < nlanes; i += 2)
+            {
+                __m128d product = _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i));
+                _mm_storeu_pd(r + i, _mm_add_pd(product, _mm_loadu_pd(c + i)));
+            }
+        }
+    }
+
+
+    bool BytecodeProgram::prepareNative(std::shared_ptr<BytecodeNativeCode> spare)
+    {
+        validate();
+        discardNative();
+        native = BytecodeNativeCode::Compile(func, std::move(spare));
+        nativeEntry = native ? native->entry : nullptr;
+        return isNative();
+    }
+
+
     void BytecodeProgram::validate() const
     {
         for (const BytecodeInstruction& inst : func)
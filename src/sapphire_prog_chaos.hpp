@@ -1,5 +1,8 @@
 #pragma once
+#include <array>
+#include <atomic>
 #include <cinttypes>
+#include <memory>
 #include <vector>
 #include <string>
 #include "chaos.hpp"
@@ -53,6 +56,10 @@ namespace Sapphire
 
     using BytecodeFunction  = std::vector<BytecodeInstruction>;
     using BytecodeRegisters = std::vector<double>;
+    using BytecodeNativeEntry = void (*)(double *reg);
+    class BytecodeNativeCode;       // defined in sapphire_prog_jit.hpp
+    class BytecodeOptimizer;
+    class BytecodeBatch;
 
     struct BytecodeLiteral
     {
@@ -83,6 +90,9 @@ namespace Sapphire
         std::vector<BytecodeLiteral> literals;      // list of numeric constants, mapped to register indexes
         uint32_t lowercaseVarsMask = 0;
         uint32_t exclusiveVarsMask = 0xffffffff;
+        int emittedCount = 0;                       // number of instructions generated before optimization
+        std::shared_ptr<BytecodeNativeCode> native;     // machine code translation of `func`, if available
+        BytecodeNativeEntry nativeEntry = nullptr;
 
         explicit BytecodeProgram()
         {
@@ -93,6 +103,7 @@ namespace Sapphire
 
         void initialize()
         {
+            discardNative();
             func.clear();
             reg.clear();
             outputs.clear();
@@ -100,6 +111,7 @@ namespace Sapphire
             for (int& v : registerForSymbol)
                 v = -1;
             lowercaseVarsMask = 0;
+            emittedCount = 0;
         }
 
         void printRegisters() const
@@ -157,7 +169,7 @@ namespace Sapphire
 
         void printFunc() const
         {
-            printf("    INSTRUCTIONS:\n");
+            printf("    INSTRUCTIONS: %d (%d before optimization)\n", static_cast<int>(func.size()), emittedCount);
             for (const BytecodeInstruction& inst : func)
             {
                 printf("        [%2d] = [%2d]*[%2d] + [%2d]", inst.r, inst.a, inst.b, inst.c);
@@ -185,17 +197,39 @@ namespace Sapphire
             return r;
         }
 
-        int compile(calc_expr_t expr)
+        int compile(calc_expr_t expr, bool optimizeCode = true)
         {
+            discardNative();
             const int resultRegister = gencode(expr, 0);
             outputs.push_back(resultRegister);
-            return resultRegister;
+            if (optimizeCode)
+                optimize();
+            return outputs.back();
         }
 
+        void optimize();
+
         void run()
         {
-            for (const BytecodeInstruction& inst : func)
-                reg[inst.r] = reg[inst.a]*reg[inst.b] + reg[inst.c];
+            if (nativeEntry)
+                nativeEntry(reg.data());
+            else
+                interpret();
+        }
+
+        void interpret();   // defined in sapphire_prog_chaos.cpp, which must not use FMA contraction
+
+        void runBatch(BytecodeBatch& batch, int nlanes) const;     // run the first `nlanes` lanes of `batch`
+
+        // Translate `func` to machine code; returns false if run() will use the interpreter.
+        // Reuses the executable memory of `spare` when possible (see BytecodeNativeCode::Compile).
+        bool prepareNative(std::shared_ptr<BytecodeNativeCode> spare = nullptr);
+        bool isNative() const { return nativeEntry != nullptr; }
+
+        void discardNative()
+        {
+            native.reset();
+            nativeEntry = nullptr;
         }
 
         void validate() const;
@@ -235,6 +269,8 @@ namespace Sapphire
         }
 
     private:
+        friend class BytecodeOptimizer;
+
         int gencode(calc_expr_t expr, int depth);
 
         int allocateRegister(double value = 0.0)
@@ -281,6 +317,7 @@ namespace Sapphire
             inst.b = validateRegister(b);
             inst.c = validateRegister(c);
             func.push_back(inst);
+            ++emittedCount;
             return r;
         }
     };
@@ -288,6 +325,57 @@ namespace Sapphire
     using BytecodeResult = TranslateResult<BytecodeProgram>;
 
 
+    class BytecodeBatch
+    {
+        // A register file for running one BytecodeProgram on many independent states at once.
+        // Laid out as [register][lane], so the lanes of each register are contiguous
+        // and each instruction can process two lanes per SIMD operation.
+        // Every lane starts with a copy of the program's registers (parameters, literals, etc).
+        // Recreate the batch, or call load() again, whenever the program is recompiled.
+
+    private:
+        int nlanes = 0;
+        int stride = 0;     // lane count rounded up to a multiple of 2
+        int nregisters = 0; // register count of the program last loaded
+        std::vector<double> storage;
+
+    public:
+        BytecodeBatch(const BytecodeProgram& prog, int laneCount);
+
+        void load(const BytecodeProgram& prog);
+
+        int laneCount() const
+        {
+            return nlanes;
+        }
+
+        int registerCount() const
+        {
+            return nregisters;
+        }
+
+        double* lanes(int r)
+        {
+            return storage.data() + static_cast<std::size_t>(r)*stride;
+        }
+
+        const double* lanes(int r) const
+        {
+            return storage.data() + static_cast<std::size_t>(r)*stride;
+        }
+
+        double& at(int r, int lane)
+        {
+            return storage.at(static_cast<std::size_t>(r)*stride + lane);
+        }
+
+        double at(int r, int lane) const
+        {
+            return storage.at(static_cast<std::size_t>(r)*stride + lane);
+        }
+    };
+
+
     struct KnobParameterMapping
     {
         // The default mapping is an identity operator:  paramValue(x) == x.
@@ -315,6 +403,45 @@ namespace Sapphire
     };
 
 
+    class BytecodeProgramQueue
+    {
+        // A lock-free queue of program pointers from exactly one producer thread
+        // to exactly one consumer thread.
+
+    private:
+        static constexpr unsigned Capacity = 8;
+        std::array<BytecodeProgram*, Capacity> slot{};
+        std::atomic<unsigned> head{0};      // next slot to pop; written only by the consumer
+        std::atomic<unsigned> tail{0};      // next slot to push; written only by the producer
+
+    public:
+        bool full() const
+        {
+            return tail.load(std::memory_order_relaxed) - head.load(std::memory_order_acquire) == Capacity;
+        }
+
+        bool push(BytecodeProgram* prog)
+        {
+            if (full())
+                return false;
+            const unsigned t = tail.load(std::memory_order_relaxed);
+            slot[t % Capacity] = prog;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        BytecodeProgram* pop()
+        {
+            const unsigned h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire))
+                return nullptr;
+            BytecodeProgram* prog = slot[h % Capacity];
+            head.store(h + 1, std::memory_order_release);
+            return prog;
+        }
+    };
+
+
     class ProgLogger
     {
     public:
@@ -331,11 +458,26 @@ namespace Sapphire
         mutable ProgLogger* logger = nullptr;
 
     private:
-        mutable BytecodeProgram prog;       // a single program that calculates vx, vy, and vz.
+        // The program is edited by resetProgram() and compile(), usually on the GUI thread.
+        // publishProgram() hands a finished copy to the audio thread, which switches to it
+        // at the next call to slopes(). Copies the audio thread no longer runs come back
+        // through `retired`, and are freed by the publishing thread, so the audio thread
+        // never frees memory or unmaps code.
 
-        int paramRegister[ParamCount]{};
+        BytecodeProgram prog;       // a single program that calculates vx, vy, and vz.
+
+        int paramRegister[ParamCount]{};    // the same in every program, set once by the constructor
         int inputRegister[InputCount]{};
 
+        mutable std::unique_ptr<BytecodeProgram> running;           // used only by the audio thread
+        mutable bool halted = false;                                // audio thread stopped `running` after an error
+        mutable std::atomic<BytecodeProgram*> pending{nullptr};     // published, not yet picked up by the audio thread
+        mutable BytecodeProgramQueue retired;                       // audio thread -> publishing thread
+        std::shared_ptr<BytecodeNativeCode> spareNative;            // executable memory to reuse on the next publish
+
+        void adoptPublishedProgram() const;
+        void recycle(BytecodeProgram* old);
+
         static int ValidateParamIndex(int index)
         {
             if (index >= 0 && index < ParamCount)
@@ -370,9 +512,19 @@ namespace Sapphire
             _xVelScale, _yVelScale, _zVelScale)
         {
             resetProgram();
+            for (int p = 0; p < ParamCount; ++p)
+                paramRegister[p] = prog.registerForSymbol.at('a' + p);
+            for (int i = 0; i < InputCount; ++i)
+                inputRegister[i] = prog.registerForSymbol.at('x' + i);
+            running = std::make_unique<BytecodeProgram>(prog);
             ProgOscillator_initialize();
         }
 
+        ~ProgOscillator();
+
+        ProgOscillator(const ProgOscillator&) = delete;
+        ProgOscillator& operator = (const ProgOscillator&) = delete;
+
         void initialize() override
         {
             ChaoticOscillator::initialize();
@@ -415,22 +567,24 @@ namespace Sapphire
 
         void resetProgram()
         {
+            // Registers are allocated in this order, so paramRegister and inputRegister never change.
             prog.initialize();
 
-            paramRegister[0] = prog.setVar('a', 0.1);
-            paramRegister[1] = prog.setVar('b', 0.1);
-            paramRegister[2] = prog.setVar('c', 14.0);
-            paramRegister[3] = prog.setVar('d', 0.0);
+            prog.setVar('a', 0.1);
+            prog.setVar('b', 0.1);
+            prog.setVar('c', 14.0);
+            prog.setVar('d', 0.0);
 
-            inputRegister[0] = prog.setVar('x', x0);
-            inputRegister[1] = prog.setVar('y', y0);
-            inputRegister[2] = prog.setVar('z', z0);
+            prog.setVar('x', x0);
+            prog.setVar('y', y0);
+            prog.setVar('z', z0);
 
             prog.setExclusiveVars("abcdxyz");
         }
 
         BytecodeResult compile(std::string infix)
         {
+            // The audio thread keeps running the previous program until publishProgram() is called.
             try
             {
                 auto expr = CalcParseNumericExpression(infix);
@@ -444,14 +598,22 @@ namespace Sapphire
             }
         }
 
+        void publishProgram();      // not safe to call from the audio thread
+
+        void haltProgram()
+        {
+            // Audio thread only: stop running the current program until the next one is published.
+            halted = true;
+        }
+
         double paramValue(int index) const
         {
-            return prog.reg.at(paramRegister[ValidateParamIndex(index)]);
+            return running->reg.at(paramRegister[ValidateParamIndex(index)]);
         }
 
         double& paramValue(int index)
         {
-            return prog.reg.at(paramRegister[ValidateParamIndex(index)]);
+            return running->reg.at(paramRegister[ValidateParamIndex(index)]);
         }
 
         uint32_t lowercaseVariables() const
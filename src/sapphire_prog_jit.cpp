@@ -0,0 +1,290 @@
+#include <algorithm>
+#include <cstring>
+#include "sapphire_prog_jit.hpp"
+
+#if SAPPHIRE_BYTECODE_NATIVE
+    #if defined(_WIN32)
+        #ifndef WIN32_LEAN_AND_MEAN
+            #define WIN32_LEAN_AND_MEAN
+        #endif
+        #ifndef NOMINMAX
+            #define NOMINMAX
+        #endif
+        #include <windows.h>
+    #else
+        #include <sys/mman.h>
+    #endif
+#endif
+
+namespace Sapphire
+{
+#if SAPPHIRE_BYTECODE_NATIVE
+    class X64Assembler
+    {
+    private:
+        std::vector<uint8_t>& code;
+
+#if defined(_WIN32)
+        static constexpr int BaseRegister = 1;      // rcx holds the register array pointer (Microsoft x64 calling convention)
+#else
+        static constexpr int BaseRegister = 7;      // rdi holds the register array pointer (System V calling convention)
+#endif
+
+        void rex(int reg, int rm)
+        {
+            int bits = 0;
+            if (reg >= 8)
+                bits |= 4;      // REX.R
+            if (rm >= 8)
+                bits |= 1;      // REX.B
+            if (bits)
+                code.push_back(static_cast<uint8_t>(0x40 | bits));
+        }
+
+        void opMemory(uint8_t prefix, uint8_t opcode, int xmm, int index)
+        {
+            // Operand is the 8-byte slot reg[index], addressed relative to the base register.
+            const int disp = 8 * index;
+            code.push_back(prefix);
+            rex(xmm, 0);
+            code.push_back(0x0f);
+            code.push_back(opcode);
+            if (disp < 0x80)
+            {
+                code.push_back(static_cast<uint8_t>(0x40 | ((xmm & 7) << 3) | BaseRegister));
+                code.push_back(static_cast<uint8_t>(disp));
+            }
+            else
+            {
+                code.push_back(static_cast<uint8_t>(0x80 | ((xmm & 7) << 3) | BaseRegister));
+                for (int i = 0; i < 4; ++i)
+                    code.push_back(static_cast<uint8_t>(disp >> (8*i)));
+            }
+        }
+
+        void opRegister(uint8_t prefix, uint8_t opcode, int xmmDest, int xmmSource)
+        {
+            code.push_back(prefix);
+            rex(xmmDest, xmmSource);
+            code.push_back(0x0f);
+            code.push_back(opcode);
+            code.push_back(static_cast<uint8_t>(0xc0 | ((xmmDest & 7) << 3) | (xmmSource & 7)));
+        }
+
+    public:
+        explicit X64Assembler(std::vector<uint8_t>& _code)
+            : code(_code)
+            {}
+
+        void load(int xmm, int index)           { opMemory(0xf2, 0x10, xmm, index); }      // movsd xmm, [base + 8*index]
+        void store(int xmm, int index)          { opMemory(0xf2, 0x11, xmm, index); }      // movsd [base + 8*index], xmm
+        void mul(int xmm, int index)            { opMemory(0xf2, 0x59, xmm, index); }      // mulsd xmm, [base + 8*index]
+        void add(int xmm, int index)            { opMemory(0xf2, 0x58, xmm, index); }      // addsd xmm, [base + 8*index]
+        void move(int xmmDest, int xmmSource)   { opRegister(0x66, 0x28, xmmDest, xmmSource); }    // movapd
+        void mulReg(int xmmDest, int xmmSource) { opRegister(0xf2, 0x59, xmmDest, xmmSource); }    // mulsd
+        void addReg(int xmmDest, int xmmSource) { opRegister(0xf2, 0x58, xmmDest, xmmSource); }    // addsd
+        void ret()                              { code.push_back(0xc3); }
+    };
+
+
+    class XmmCache
+    {
+        // Tracks which bytecode registers currently have their values held in XMM registers,
+        // so results can be fed directly into later instructions instead of reloading them.
+        // Every result is still stored to memory, so the register array is always up to date.
+
+    private:
+#if defined(_WIN32)
+        static constexpr int NumXmm = 6;        // xmm6..xmm15 are callee-saved in the Microsoft x64 calling convention
+#else
+        static constexpr int NumXmm = 16;
+#endif
+        int holds[NumXmm];
+        int lastUse[NumXmm]{};
+        int clock = 0;
+
+    public:
+        XmmCache()
+        {
+            for (int& h : holds)
+                h = -1;
+        }
+
+        int find(int index) const
+        {
+            for (int x = 0; x < NumXmm; ++x)
+                if (holds[x] == index)
+                    return x;
+            return -1;
+        }
+
+        int victim(int x1, int x2, int x3) const
+        {
+            // Pick the least recently used XMM register that is not an operand of the current instruction.
+            int best = -1;
+            for (int x = 0; x < NumXmm; ++x)
+                if (x != x1 && x != x2 && x != x3)
+                    if (best < 0 || lastUse[x] < lastUse[best])
+                        best = x;
+            return best;
+        }
+
+        void touch(int x)
+        {
+            if (x >= 0)
+                lastUse[x] = ++clock;
+        }
+
+        void assign(int x, int index)
+        {
+            for (int& h : holds)
+                if (h == index)
+                    h = -1;
+            holds[x] = index;
+            touch(x);
+        }
+    };
+
+
+    static void GenerateCode(std::vector<uint8_t>& code, const BytecodeFunction& func)
+    {
+        // Each bytecode instruction  reg[r] = reg[a]*reg[b] + reg[c]
+        // becomes a multiply followed by a separate add, exactly like the interpreter,
+        // so both backends produce bit-identical results.
+        X64Assembler as(code);
+        XmmCache cache;
+        for (const BytecodeInstruction& inst : func)
+        {
+            const int xa = cache.find(inst.a);
+            const int xb = cache.find(inst.b);
+            const int xc = cache.find(inst.c);
+            const int xr = cache.victim(xa, xb, xc);
+
+            if (xa >= 0)
+                as.move(xr, xa);
+            else
+                as.load(xr, inst.a);
+
+            if (xb >= 0)
+                as.mulReg(xr, xb);
+            else
+                as.mul(xr, inst.b);
+
+            if (xc >= 0)
+                as.addReg(xr, xc);
+            else
+                as.add(xr, inst.c);
+
+            as.store(xr, inst.r);
+
+            cache.touch(xa);
+            cache.touch(xb);
+            cache.touch(xc);
+            cache.assign(xr, inst.r);
+        }
+        as.ret();
+    }
+
+
+    static std::size_t ExecutableCapacity(std::size_t codeSize)
+    {
+        // Round up to whole pages, so later recompiles of similar size fit in the same memory.
+        constexpr std::size_t page = 0x1000;
+        return std::max(page, (codeSize + page - 1) & ~(page - 1));
+    }
+
+
+    static void* AllocateExecutable(std::size_t capacity)
+    {
+        // Returns read-only pages for WriteExecutable to fill,
+        // or nullptr if the operating system does not provide them.
+#if defined(_WIN32)
+        return VirtualAlloc(nullptr, capacity, MEM_COMMIT | MEM_RESERVE, PAGE_READONLY);
+#else
+        void *mem = mmap(nullptr, capacity, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return (mem == MAP_FAILED) ? nullptr : mem;
+#endif
+    }
+
+
+    static bool WriteExecutable(void *mem, std::size_t capacity, const std::vector<uint8_t>& code)
+    {
+        // Make the pages writable, copy the code in, then flip them to executable.
+        // The caller must make sure no thread is running the old code in these pages.
+#if defined(_WIN32)
+        DWORD oldProtect;
+        if (!VirtualProtect(mem, capacity, PAGE_READWRITE, &oldProtect))
+            return false;
+        std::memcpy(mem, code.data(), code.size());
+        if (!VirtualProtect(mem, capacity, PAGE_EXECUTE_READ, &oldProtect))
+            return false;
+        FlushInstructionCache(GetCurrentProcess(), mem, code.size());
+        return true;
+#else
+        if (mprotect(mem, capacity, PROT_READ | PROT_WRITE) != 0)
+            return false;
+        std::memcpy(mem, code.data(), code.size());
+        return mprotect(mem, capacity, PROT_READ | PROT_EXEC) == 0;
+#endif
+    }
+
+
+    static void FreeExecutable(void *mem, std::size_t capacity)
+    {
+#if defined(_WIN32)
+        (void)capacity;
+        VirtualFree(mem, 0, MEM_RELEASE);
+#else
+        munmap(mem, capacity);
+#endif
+    }
+#endif  // SAPPHIRE_BYTECODE_NATIVE
+
+
+    BytecodeNativeCode::~BytecodeNativeCode()
+    {
+#if SAPPHIRE_BYTECODE_NATIVE
+        if (memory)
+            FreeExecutable(memory, capacity);
+#endif
+    }
+
+
+    std::shared_ptr<BytecodeNativeCode> BytecodeNativeCode::Compile(
+        const BytecodeFunction& func,
+        std::shared_ptr<BytecodeNativeCode> spare)
+    {
+#if SAPPHIRE_BYTECODE_NATIVE
+        std::vector<uint8_t> code;
+        GenerateCode(code, func);
+
+        // Reuse the spare's pages when the code fits, instead of mapping new ones.
+        std::shared_ptr<BytecodeNativeCode> native;
+        if (spare && spare.use_count() == 1 && spare->memory && code.size() <= spare->capacity)
+        {
+            native = std::move(spare);
+            native->entry = nullptr;
+        }
+        else
+        {
+            const std::size_t capacity = ExecutableCapacity(code.size());
+            void *mem = AllocateExecutable(capacity);
+            if (mem == nullptr)
+                return nullptr;
+            native = std::shared_ptr<BytecodeNativeCode>(new BytecodeNativeCode());
+            native->memory = mem;
+            native->capacity = capacity;
+        }
+
+        if (!WriteExecutable(native->memory, native->capacity, code))
+            return nullptr;
+
+        native->entry = reinterpret_cast<BytecodeNativeEntry>(native->memory);
+        return native;
+#else
+        (void)func;
+        (void)spare;
+        return nullptr;
+#endif
+    }
+}
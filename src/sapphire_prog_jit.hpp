@@ -0,0 +1,42 @@
+#pragma once
+#include <memory>
+#include "sapphire_prog_chaos.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define SAPPHIRE_BYTECODE_NATIVE 1
+#else
+    #define SAPPHIRE_BYTECODE_NATIVE 0
+#endif
+
+namespace Sapphire
+{
+    // BytecodeNativeCode translates a BytecodeFunction into x86-64 machine code.
+    // The generated function takes a pointer to the register array and
+    // runs every instruction in a straight line, with no loop or decoding overhead.
+    // Intermediate results stay in XMM registers where possible,
+    // instead of making a round trip through memory before each dependent instruction.
+
+    class BytecodeNativeCode
+    {
+    private:
+        void *memory = nullptr;
+        std::size_t capacity = 0;       // bytes of executable pages, a whole number of pages
+
+        BytecodeNativeCode() {}
+
+    public:
+        BytecodeNativeEntry entry = nullptr;
+
+        BytecodeNativeCode(const BytecodeNativeCode&) = delete;
+        BytecodeNativeCode& operator = (const BytecodeNativeCode&) = delete;
+        ~BytecodeNativeCode();
+
+        // Returns nullptr when native code is not supported on this CPU/platform,
+        // or the operating system refuses to provide executable memory.
+        // If `spare` is not shared with anyone else and is big enough, its pages are
+        // rewritten and reused. No thread may still be running the spare's old code.
+        static std::shared_ptr<BytecodeNativeCode> Compile(
+            const BytecodeFunction& func,
+            std::shared_ptr<BytecodeNativeCode> spare = nullptr);
+    };
+}
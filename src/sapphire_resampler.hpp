@@ -0,0 +1,508 @@
+// Sapphire for VCV Rack 2, by Don Cross <cosinekitty@gmail.com>
+// https://github.com/cosinekitty/sapphire
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+#include "sapphire_simd.hpp"
+
+namespace Sapphire
+{
+    namespace Resampler
+    {
+        template <unsigned maxChannels>
+        struct Frame
+        {
+            float sample[maxChannels]{};
+
+            void clear()
+            {
+                for (unsigned i = 0; i < maxChannels; ++i)
+                    sample[i] = 0;
+            }
+        };
+
+
+        template <unsigned maxChannels, unsigned maxQueueFrames>
+        struct RingQueue
+        {
+            // A circular queue of frames. Once a frame is written, it stays where it is
+            // until it is consumed. Callers that need contiguous memory, like
+            // dsp::SampleRateConverter, work with the spans returned by readSpan/writeSpan,
+            // which are at most two pieces long when the data wraps around the end of the buffer.
+
+            static const unsigned nchannels = maxChannels;
+            Frame<maxChannels> buffer[maxQueueFrames];
+            unsigned head = 0;          // index of the oldest frame
+            unsigned length = 0;        // number of frames in the queue
+
+            static unsigned wrap(unsigned index)
+            {
+                return (index >= maxQueueFrames) ? (index - maxQueueFrames) : index;
+            }
+
+            void initialize()
+            {
+                head = 0;
+                length = 0;
+            }
+
+            Frame<maxChannels>& at(unsigned offset)
+            {
+                // The frame `offset` frames after the oldest frame. Requires offset < length.
+                return buffer[wrap(head + offset)];
+            }
+
+            Frame<maxChannels>& tail()
+            {
+                // The slot the next appended frame goes into. Requires !full().
+                return buffer[wrap(head + length)];
+            }
+
+            void append(const Frame<maxChannels>& frame)
+            {
+                if (length < maxQueueFrames)
+                {
+                    tail() = frame;
+                    ++length;
+                }
+            }
+
+            void consume(unsigned nframes)
+            {
+                if (nframes >= length)
+                {
+                    initialize();
+                    return;
+                }
+                head = wrap(head + nframes);
+                length -= nframes;
+            }
+
+            void advance(unsigned nframes)
+            {
+                length += nframes;
+                assert(length <= maxQueueFrames);
+            }
+
+            float* readSpan(unsigned& nframes)
+            {
+                // The oldest frames that are contiguous in memory.
+                nframes = std::min(length, maxQueueFrames - head);
+                return &buffer[head].sample[0];
+            }
+
+            float* writeSpan(unsigned& nframes)
+            {
+                // The unused slots after the newest frame that are contiguous in memory.
+                const unsigned index = wrap(head + length);
+                nframes = (index < head) ? (head - index) : (maxQueueFrames - index);
+                nframes = std::min(nframes, unusedFrameCount());
+                return &buffer[index].sample[0];
+            }
+
+            bool empty() const
+            {
+                return length == 0;
+            }
+
+            bool full() const
+            {
+                return length == maxQueueFrames;
+            }
+
+            unsigned unusedFrameCount() const
+            {
+                return maxQueueFrames - length;
+            }
+        };
+
+
+        template <typename converter_t, typename queue_t>
+        void Resample(converter_t& resamp, queue_t& source, queue_t& target)
+        {
+            // Feed as many source frames as possible through the resampler into the target.
+            // Either queue can wrap around the end of its buffer, so it can take
+            // more than one call to the resampler. Stop when it makes no more progress.
+            for (int pass = 0; pass < 4; ++pass)
+            {
+                unsigned nsource, ntarget;
+                float *src = source.readSpan(nsource);
+                float *dst = target.writeSpan(ntarget);
+                if (nsource == 0 || ntarget == 0)
+                    break;
+
+                int inFrames = static_cast<int>(nsource);
+                int outFrames = static_cast<int>(ntarget);
+                resamp.process(src, queue_t::nchannels, &inFrames, dst, queue_t::nchannels, &outFrames);
+                source.consume(inFrames);
+                target.advance(outFrames);
+                if (inFrames == 0 && outFrames == 0)
+                    break;
+            }
+        }
+
+
+        template <unsigned maxChannels>
+        class PolyphaseResampler
+        {
+            // A self-contained sample rate converter with the same interface as
+            // Rack's dsp::SampleRateConverter, so it can be used without Rack.
+            //
+            // The ratio of the two rates is reduced to L/M. Output frame n lands on input time n*M/L,
+            // so the position between input frames is always one of L phases.
+            // Each phase has a precomputed row of Blackman-windowed sinc weights.
+            // When L is too large for a reasonable table, the weights are blended
+            // linearly between the two nearest of MaxPhases rows.
+            //
+            // Quality sets the number of taps (8 per quality step), trading CPU time and
+            // latency for a sharper anti-aliasing filter. The latency is taps/2 input frames.
+
+        public:
+            static const int MinQuality = 1;
+            static const int MaxQuality = 8;
+            static const int DefaultQuality = 4;
+            static const int MaxPhases = 512;
+
+        private:
+            int inRate = 0;
+            int outRate = 0;
+            int channels = maxChannels;
+            int quality = DefaultQuality;
+            int ntaps = 0;
+            int L = 1;                      // output frames per cycle of phases
+            int M = 1;                      // input frames per cycle of phases
+            int nphases = 1;                // number of table rows, not counting the extra row for blending
+            int phase = 0;                  // position of the next output frame between input frames, in units of 1/L
+            int need = 1;                   // how many more input frames to read before the next output frame
+            int pos = 0;                    // where the next input sample goes in each history buffer
+            std::vector<float> table;       // [nphases+1][ntaps]
+            std::vector<float> history;     // [maxChannels][2*ntaps]: each sample is written twice, so the newest ntaps are contiguous
+            std::vector<float> blend;       // [ntaps] weights for the current phase when blending rows
+
+            void configure()
+            {
+                ntaps = 8 * quality;
+                const int g = std::gcd(inRate, outRate);
+                L = outRate / g;
+                M = inRate / g;
+                nphases = std::min(L, MaxPhases);
+
+                // Put the cutoff just low enough that the Blackman transition band
+                // mostly lands below the lower of the two Nyquist frequencies.
+                const double rolloff = 1.0 - 4.0/ntaps;
+                const double cutoff = rolloff * std::min(1.0, static_cast<double>(outRate) / inRate);
+                const double half = ntaps / 2.0;
+
+                table.resize((nphases + 1) * ntaps);
+                std::vector<double> h(ntaps);
+                for (int row = 0; row <= nphases; ++row)
+                {
+                    float *w = &table[row * ntaps];
+                    const double frac = static_cast<double>(row) / nphases;
+                    double sum = 0;
+                    for (int k = 0; k < ntaps; ++k)
+                    {
+                        // Tap k multiplies the input frame at distance d from the output time.
+                        const double d = (k + 1 - half) - frac;
+                        const double angle = M_PI * cutoff * d;
+                        const double sinc = (std::abs(angle) < 1.0e-12) ? 1.0 : std::sin(angle) / angle;
+                        const double x = d / half;
+                        const double blackman = (std::abs(x) >= 1.0) ? 0.0 : (0.42 + 0.5*std::cos(M_PI*x) + 0.08*std::cos(2*M_PI*x));
+                        h[k] = sinc * blackman;
+                        sum += h[k];
+                    }
+
+                    // Normalize every row for exact unity gain at DC.
+                    for (int k = 0; k < ntaps; ++k)
+                        w[k] = static_cast<float>(h[k] / sum);
+                }
+
+                history.resize(maxChannels * 2 * ntaps);
+                blend.resize(ntaps);
+                reset();
+            }
+
+            const float* weights()
+            {
+                if (nphases == L)
+                    return &table[phase * ntaps];
+
+                const double u = (static_cast<double>(phase) * nphases) / L;
+                const int row = static_cast<int>(u);
+                const float t = static_cast<float>(u - row);
+                const float *a = &table[row * ntaps];
+                const float *b = a + ntaps;
+                const __m128 vt = _mm_set1_ps(t);
+                for (int k = 0; k < ntaps; k += 4)
+                {
+                    const __m128 va = _mm_loadu_ps(a + k);
+                    const __m128 vb = _mm_loadu_ps(b + k);
+                    _mm_storeu_ps(&blend[k], _mm_add_ps(va, _mm_mul_ps(vt, _mm_sub_ps(vb, va))));
+                }
+                return blend.data();
+            }
+
+            float dot(const float *x, const float *w) const
+            {
+                __m128 sum = _mm_setzero_ps();
+                for (int k = 0; k < ntaps; k += 4)
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(x + k), _mm_loadu_ps(w + k)));
+                float s[4];
+                _mm_storeu_ps(s, sum);
+                return (s[0] + s[1]) + (s[2] + s[3]);
+            }
+
+        public:
+            void reset()
+            {
+                std::fill(history.begin(), history.end(), 0.0f);
+                phase = 0;
+                need = 1;
+                pos = 0;
+            }
+
+            void setRates(int inSampleRate, int outSampleRate)
+            {
+                if (inSampleRate <= 0 || outSampleRate <= 0)
+                    throw std::range_error("Resampler rates must be positive.");
+
+                if (inSampleRate != inRate || outSampleRate != outRate)
+                {
+                    inRate = inSampleRate;
+                    outRate = outSampleRate;
+                    configure();
+                }
+            }
+
+            void setQuality(int q)
+            {
+                q = std::max(MinQuality, std::min(MaxQuality, q));
+                if (q != quality)
+                {
+                    quality = q;
+                    if (inRate > 0)
+                        configure();
+                }
+            }
+
+            int getQuality() const
+            {
+                return quality;
+            }
+
+            int getLatency() const
+            {
+                // The delay, in input frames, between a signal going in and coming out.
+                return ntaps / 2;
+            }
+
+            void setChannels(int nchannels)
+            {
+                channels = std::max(0, std::min(static_cast<int>(maxChannels), nchannels));
+            }
+
+            void process(const float* in, int inStride, int* inFrames, float* out, int outStride, int* outFrames)
+            {
+                // Reads up to *inFrames input frames and writes up to *outFrames output frames.
+                // On return, they hold the number of frames actually read and written.
+                // The output depends only on the input stream, not on how it was split into calls.
+                if (inRate == outRate)
+                {
+                    const int n = std::min(*inFrames, *outFrames);
+                    for (int i = 0; i < n; ++i)
+                        for (int c = 0; c < channels; ++c)
+                            out[i*outStride + c] = in[i*inStride + c];
+                    *inFrames = *outFrames = n;
+                    return;
+                }
+
+                int i = 0;
+                int o = 0;
+                const int hsize = 2 * ntaps;
+                while (true)
+                {
+                    while (need > 0 && i < *inFrames)
+                    {
+                        for (int c = 0; c < channels; ++c)
+                        {
+                            float *h = &history[c * hsize];
+                            h[pos] = h[pos + ntaps] = in[i*inStride + c];
+                        }
+                        pos = (pos + 1 < ntaps) ? (pos + 1) : 0;
+                        --need;
+                        ++i;
+                    }
+
+                    if (need > 0 || o == *outFrames)
+                        break;
+
+                    // The newest ntaps input frames for each channel start at `pos`.
+                    const float *w = weights();
+                    for (int c = 0; c < channels; ++c)
+                        out[o*outStride + c] = dot(&history[c*hsize + pos], w);
+                    ++o;
+
+                    phase += M;
+                    need = phase / L;
+                    phase %= L;
+                }
+
+                *inFrames = i;
+                *outFrames = o;
+            }
+        };
+
+
+        template <unsigned maxInputChannels, unsigned maxOutputChannels>
+        class InternalModel
+        {
+        public:
+            virtual void processInternalFrame(
+                const Frame<maxInputChannels>& inFrame,
+                Frame<maxOutputChannels>& outFrame,
+                int sampleRate) = 0;
+        };
+
+
+        template <
+            unsigned maxInputChannels,
+            unsigned maxOutputChannels,
+            unsigned maxQueueFrames,
+            typename inConverter_t = PolyphaseResampler<maxInputChannels>,
+            typename outConverter_t = PolyphaseResampler<maxOutputChannels>>
+        struct Hamburger
+        {
+            // I call this a Hamburger because it sandwiches an internal "model" sample rate
+            // between two common external "signal" sample rates.
+            // For example, a process() method can be operating at 44.1 kHz signal rate,
+            // with a physical model operating at a rate of 48 kHz.
+            // Input arrives, and output leaves, at 44.1 kHz, while the internal model operates
+            // at 48 kHz. This pattern ensures consistent behavior of physical models
+            // for a variable signal rate.
+            // The converters can be anything with the interface of Rack's dsp::SampleRateConverter.
+
+            int signalRate = 0;
+            int modelRate = 0;
+
+            bool canSkipResampler() const
+            {
+                // If the model sample rate is zero, it is a flag that
+                // the caller wants to disable the resampler logic and operate
+                // the model at the same rate as the signal.
+                // Also, if both rates match, it means no resampling is necessary.
+                return modelRate == 0 || modelRate == signalRate;
+            }
+
+            RingQueue<maxInputChannels, maxQueueFrames> signalInQueue;
+            inConverter_t inResamp;
+            RingQueue<maxInputChannels, maxQueueFrames> modelInQueue;
+
+            RingQueue<maxOutputChannels, maxQueueFrames> modelOutQueue;
+            outConverter_t outResamp;
+            RingQueue<maxOutputChannels, maxQueueFrames> signalOutQueue;
+
+            void setRates(int signalSampleRate, int modelSampleRate)
+            {
+                signalRate = signalSampleRate;
+                modelRate = modelSampleRate;
+                if (!canSkipResampler())
+                {
+                    inResamp.setRates(signalRate, modelRate);
+                    outResamp.setRates(modelRate, signalRate);
+                }
+            }
+
+            void initialize()
+            {
+                signalInQueue.initialize();
+                modelInQueue.initialize();
+                modelOutQueue.initialize();
+                signalOutQueue.initialize();
+            }
+
+            void process(
+                InternalModel<maxInputChannels, maxOutputChannels>& model,
+                const Frame<maxInputChannels>& signalInFrame,
+                unsigned inputChannelCount,
+                Frame<maxOutputChannels>& signalOutFrame,
+                unsigned outputChannelCount)
+            {
+                processBlock(model, &signalInFrame, inputChannelCount, &signalOutFrame, outputChannelCount, 1);
+            }
+
+            void processBlock(
+                InternalModel<maxInputChannels, maxOutputChannels>& model,
+                const Frame<maxInputChannels>* signalInFrames,
+                unsigned inputChannelCount,
+                Frame<maxOutputChannels>* signalOutFrames,
+                unsigned outputChannelCount,
+                unsigned nframes)
+            {
+                // Converts `nframes` signal frames into model frames, runs the model,
+                // and converts the results back into `nframes` signal frames.
+                // Each resampler call handles everything that is ready, instead of one frame at a time.
+                if (canSkipResampler())
+                {
+                    for (unsigned i = 0; i < nframes; ++i)
+                        model.processInternalFrame(signalInFrames[i], signalOutFrames[i], signalRate);
+                    return;
+                }
+
+                inResamp.setChannels(inputChannelCount);
+                outResamp.setChannels(outputChannelCount);
+
+                // Split the block into chunks small enough that the resampled frames
+                // always fit in the queues, no matter which rate is higher.
+                const long long fastRate = std::max(signalRate, modelRate);
+                const unsigned chunk = std::max<unsigned>(1, static_cast<unsigned>((maxQueueFrames * static_cast<long long>(signalRate)) / (2 * fastRate)));
+                for (unsigned offset = 0; offset < nframes; offset += chunk)
+                {
+                    const unsigned n = std::min(chunk, nframes - offset);
+                    processChunk(model, signalInFrames + offset, signalOutFrames + offset, n);
+                }
+            }
+
+        private:
+            void processChunk(
+                InternalModel<maxInputChannels, maxOutputChannels>& model,
+                const Frame<maxInputChannels>* signalInFrames,
+                Frame<maxOutputChannels>* signalOutFrames,
+                unsigned nframes)
+            {
+                for (unsigned i = 0; i < nframes; ++i)
+                    signalInQueue.append(signalInFrames[i]);
+
+                // Feed as many inbound signal frames as possible through the input resampler.
+                Resample(inResamp, signalInQueue, modelInQueue);
+
+                // Run as many frames as possible through the model.
+                // The model writes its output directly into the output queue.
+                while (!modelInQueue.empty() && !modelOutQueue.full())
+                {
+                    model.processInternalFrame(modelInQueue.at(0), modelOutQueue.tail(), modelRate);
+                    modelOutQueue.advance(1);
+                    modelInQueue.consume(1);
+                }
+
+                // Resample as many model output frames as possible.
+                Resample(outResamp, modelOutQueue, signalOutQueue);
+
+                // Hopefully we have enough output frames available,
+                // but we might not at the very beginning. When that happens,
+                // output frames full of zeroes.
+                const unsigned nready = std::min(nframes, signalOutQueue.length);
+                const unsigned nsilent = nframes - nready;
+                for (unsigned i = 0; i < nsilent; ++i)
+                    signalOutFrames[i].clear();
+                for (unsigned i = 0; i < nready; ++i)
+                    signalOutFrames[nsilent + i] = signalOutQueue.at(i);
+                signalOutQueue.consume(nready);
+            }
+        };
+    }
+}
@@ -214,4 +214,57 @@ namespace Sapphire
     }
 
     using PhysicsVectorList = std::vector<PhysicsVector>;
+
+
+    class DoublePair
+    {
+        // Two double-precision lanes in one SSE2 register.
+        // Each lane gets exactly the same result as the equivalent scalar double arithmetic.
+    public:
+        union {
+            __m128d v;
+            double s[2];
+        };
+
+        DoublePair()
+            : v(_mm_set1_pd(0.0))
+            {}
+
+        DoublePair(double x)        // cppcheck-suppress [noExplicitConstructor]
+            : v(_mm_set1_pd(x))
+            {}
+
+        explicit DoublePair(__m128d _v)
+            : v(_v)
+            {}
+
+        double& operator[](int i) { return s[i]; }
+        const double& operator[](int i) const { return s[i]; }
+    };
+
+    inline DoublePair operator + (const DoublePair& a, const DoublePair& b)
+    {
+        return DoublePair(_mm_add_pd(a.v, b.v));
+    }
+
+    inline DoublePair operator - (const DoublePair& a, const DoublePair& b)
+    {
+        return DoublePair(_mm_sub_pd(a.v, b.v));
+    }
+
+    inline DoublePair operator * (const DoublePair& a, const DoublePair& b)
+    {
+        return DoublePair(_mm_mul_pd(a.v, b.v));
+    }
+
+    inline DoublePair operator / (const DoublePair& a, const DoublePair& b)
+    {
+        return DoublePair(_mm_div_pd(a.v, b.v));
+    }
+
+    inline DoublePair& operator += (DoublePair& a, const DoublePair& b)
+    {
+        a = a + b;
+        return a;
+    }
 }
@@ -1,8 +1,12 @@
 #pragma once
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <vector>
 #include "sapphire_engine.hpp"
+#include "sapphire_control_rate.hpp"
 #include "sapphire_crossfader.hpp"
 
 namespace Sapphire
@@ -10,10 +14,14 @@ namespace Sapphire
     constexpr float TAPELOOP_MIN_DELAY_SECONDS = 0.1;
     constexpr float TAPELOOP_MAX_DELAY_SECONDS = 10;
     constexpr float TAPELOOP_CROSSOVER_SECONDS = 0.05;
+    constexpr float TAPELOOP_MIN_TAPE_SECONDS = 0.5;
     static_assert(TAPELOOP_MAX_DELAY_SECONDS > TAPELOOP_MIN_DELAY_SECONDS);
     static_assert(TAPELOOP_CROSSOVER_SECONDS < TAPELOOP_MIN_DELAY_SECONDS);
 
     constexpr float TAPELOOP_RECORD_VOLTAGE_LIMIT = 100;
+    constexpr float TAPELOOP_INT16_VOLTAGE_RANGE = 16;     // Int16 tape saturates beyond this many volts
+    constexpr float TAPELOOP_INT16_SCALE = 32767 / TAPELOOP_INT16_VOLTAGE_RANGE;
+    static_assert(TAPELOOP_INT16_VOLTAGE_RANGE < TAPELOOP_RECORD_VOLTAGE_LIMIT);
     constexpr unsigned TAPELOOP_MIN_SAMPLE_RATE_HZ = 1000;
 
     class TapeDelayMotor
@@ -73,66 +81,484 @@ namespace Sapphire
     };
 
 
+    enum class TapeStorage
+    {
+        Float32,        // full quality
+        Float16,        // half the memory; about 3 significant digits at any level
+        Int16,          // half the memory; steps of TAPELOOP_INT16_VOLTAGE_RANGE/32767 volts, saturating beyond that range
+        LEN,
+
+        Default = Float32
+    };
+
+
+    // Conversions between float and the 16-bit tape formats.
+    // The scalar and 4-lane versions use the same arithmetic, so they always agree,
+    // even when the CPU flushes denormals to zero. Only SSE2 is required.
+    // The half-precision conversions round to nearest even; they are adapted from
+    // Fabian Giesen's public domain code: https://gist.github.com/rygorous/2156668
+
+    inline uint32_t FloatBits(float x)
+    {
+        uint32_t u;
+        std::memcpy(&u, &x, sizeof(u));
+        return u;
+    }
+
+    inline float BitsFloat(uint32_t u)
+    {
+        float x;
+        std::memcpy(&x, &u, sizeof(x));
+        return x;
+    }
+
+    inline uint16_t FloatToHalf(float x)
+    {
+        const uint32_t sign = FloatBits(x) & 0x80000000u;
+        const uint32_t a = FloatBits(x) ^ sign;
+        uint32_t h;
+        if (a >= ((127 + 16) << 23))
+        {
+            h = (a > (255u << 23)) ? 0x7e00 : 0x7c00;   // NAN or infinity
+        }
+        else if (a < ((127 - 14) << 23))
+        {
+            // The result is subnormal: let the floating point adder do the rounding.
+            const uint32_t magic = ((127 - 15) + (23 - 10) + 1) << 23;
+            h = FloatBits(BitsFloat(a) + BitsFloat(magic)) - magic;
+        }
+        else
+        {
+            const uint32_t mantissaOdd = (a >> 13) & 1;
+            h = (a + (0xfff - ((127 - 15) << 23)) + mantissaOdd) >> 13;
+        }
+        return static_cast<uint16_t>(h | (sign >> 16));
+    }
+
+    inline float HalfToFloat(uint16_t h)
+    {
+        const uint32_t a = h & 0x7fff;
+        float x = BitsFloat(a << 13) * BitsFloat((254 - 15) << 23);
+        if (a > 0x7bff)
+            x = BitsFloat(FloatBits(x) | (255u << 23));    // NAN or infinity
+        return BitsFloat(FloatBits(x) | (static_cast<uint32_t>(h & 0x8000) << 16));
+    }
+
+    inline void FloatToHalf4(const float* x, uint16_t* h)
+    {
+        const __m128 f = _mm_loadu_ps(x);
+        const __m128 justSign = _mm_and_ps(f, _mm_castsi128_ps(_mm_set1_epi32(0x80000000u)));
+        const __m128 absf = _mm_xor_ps(f, justSign);
+        const __m128i a = _mm_castps_si128(absf);
+        const __m128i isRegular = _mm_cmpgt_epi32(_mm_set1_epi32((127 + 16) << 23), a);
+        const __m128i isNan = _mm_castps_si128(_mm_cmpunord_ps(absf, absf));
+        const __m128i special = _mm_or_si128(_mm_and_si128(isNan, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7c00));
+        const __m128i isSubnormal = _mm_cmpgt_epi32(_mm_set1_epi32((127 - 14) << 23), a);
+
+        const __m128i magic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+        const __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absf, _mm_castsi128_ps(magic))), magic);
+
+        const __m128i mantissaOdd = _mm_srai_epi32(_mm_slli_epi32(a, 31 - 13), 31);
+        const __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(a, _mm_set1_epi32(0xfff - ((127 - 15) << 23))), mantissaOdd), 13);
+
+        const __m128i regular = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+        const __m128i joined = _mm_or_si128(_mm_and_si128(isRegular, regular), _mm_andnot_si128(isRegular, special));
+        const __m128i result = _mm_or_si128(joined, _mm_srai_epi32(_mm_castps_si128(justSign), 16));
+
+        // Every lane is in the range of a signed 16-bit integer, so saturating pack is exact.
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(h), _mm_packs_epi32(result, result));
+    }
+
+    inline void HalfToFloat4(const uint16_t* h, float* x)
+    {
+        const __m128i w = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(h)), _mm_setzero_si128());
+        const __m128i a = _mm_and_si128(w, _mm_set1_epi32(0x7fff));
+        const __m128i sign = _mm_slli_epi32(_mm_xor_si128(w, a), 16);
+        const __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(a, 13)), _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23)));
+        const __m128i wasSpecial = _mm_cmpgt_epi32(a, _mm_set1_epi32(0x7bff));
+        const __m128 specialExponent = _mm_and_ps(_mm_castsi128_ps(wasSpecial), _mm_castsi128_ps(_mm_set1_epi32(255 << 23)));
+        _mm_storeu_ps(x, _mm_or_ps(scaled, _mm_or_ps(_mm_castsi128_ps(sign), specialExponent)));
+    }
+
+    inline int16_t FloatToInt16(float x)
+    {
+        // Round to nearest even, the same way _mm_cvtps_epi32 does, then saturate.
+        return static_cast<int16_t>(std::clamp(_mm_cvtss_si32(_mm_set_ss(x * TAPELOOP_INT16_SCALE)), -32767, +32767));
+    }
+
+    inline float Int16ToFloat(int16_t i)
+    {
+        return static_cast<float>(i) * (1 / TAPELOOP_INT16_SCALE);
+    }
+
+    inline void FloatToInt164(const float* x, int16_t* i)
+    {
+        const __m128i n = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(x), _mm_set1_ps(TAPELOOP_INT16_SCALE)));
+        const __m128i c = _mm_max_epi16(_mm_packs_epi32(n, n), _mm_set1_epi16(-32767));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(i), c);
+    }
+
+    inline void Int16ToFloat4(const int16_t* i, float* x)
+    {
+        const __m128i w = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(i));
+        const __m128i n = _mm_srai_epi32(_mm_unpacklo_epi16(w, w), 16);     // sign extend
+        _mm_storeu_ps(x, _mm_mul_ps(_mm_cvtepi32_ps(n), _mm_set1_ps(1 / TAPELOOP_INT16_SCALE)));
+    }
+
+
+    inline std::atomic<std::size_t>& TapeMemoryCounter()
+    {
+        // The number of bytes in all tape buffers in the process, including spares held by pools.
+        static std::atomic<std::size_t> total{0};
+        return total;
+    }
+
+
+    using tape_word_t = uint16_t;       // tapes are stored as 16-bit words: two per sample for Float32, one otherwise
+
+
+    class TapeLoopPool
+    {
+        // Tape buffers that TapeLoops have outgrown are kept here,
+        // so that other loops sharing the pool can reuse them instead of allocating more memory.
+        // Not thread-safe: all the loops that share a pool must run on the same thread.
+        // The exception is getUsedBytes() and getSpareBytes(), which any thread may call,
+        // for example to show memory usage in a menu.
+
+    private:
+        static constexpr std::size_t maxSpareCount = 16;
+        std::vector<std::vector<tape_word_t>> spare;
+        std::atomic<std::size_t> usedBytes{0};
+        std::atomic<std::size_t> spareBytes{0};
+        int growthBudget = -1;      // negative until beginFrame() is called: growth is not paced
+
+        static std::size_t Bytes(const std::vector<tape_word_t>& v)
+        {
+            return v.capacity() * sizeof(tape_word_t);
+        }
+
+    public:
+        void beginFrame()
+        {
+            // Call once per audio frame, before running the loops that share this pool.
+            // Then only one loop per frame can grow ahead of time, so the channels of a
+            // polyphonic module spread their reallocations over consecutive frames.
+            growthBudget = 1;
+        }
+
+        bool claimGrowth()
+        {
+            if (growthBudget < 0)
+                return true;
+
+            if (growthBudget == 0)
+                return false;
+
+            --growthBudget;
+            return true;
+        }
+
+        std::vector<tape_word_t> acquire(std::size_t length)
+        {
+            // Returns a buffer of `length` words. Their contents are unspecified:
+            // the caller must write every word before reading any of them.
+            // Reuse the smallest spare buffer that is big enough, if there is one.
+            std::size_t best = spare.size();
+            for (std::size_t i = 0; i < spare.size(); ++i)
+                if (spare[i].capacity() >= length)
+                    if (best == spare.size() || spare[i].capacity() < spare[best].capacity())
+                        best = i;
+
+            std::vector<tape_word_t> buffer;
+            if (best < spare.size())
+            {
+                spareBytes -= Bytes(spare[best]);
+                buffer = std::move(spare[best]);
+                spare.erase(spare.begin() + best);
+            }
+            else if (!spare.empty())
+            {
+                // Nothing fits, so the loops are growing past the spare buffers.
+                // Free the smallest one; the others go on later calls,
+                // so a single call never frees a pile of buffers.
+                auto smallest = std::min_element(spare.begin(), spare.end(),
+                    [](const std::vector<tape_word_t>& a, const std::vector<tape_word_t>& b) { return a.capacity() < b.capacity(); });
+                TapeMemoryCounter() -= Bytes(*smallest);
+                spareBytes -= Bytes(*smallest);
+                spare.erase(smallest);
+            }
+            const std::size_t before = Bytes(buffer);
+            buffer.resize(length);
+            TapeMemoryCounter() += Bytes(buffer) - before;
+            usedBytes += Bytes(buffer);
+            return buffer;
+        }
+
+        void release(std::vector<tape_word_t>& buffer)
+        {
+            if (buffer.capacity() == 0)
+                return;
+
+            usedBytes -= Bytes(buffer);
+            spareBytes += Bytes(buffer);
+            spare.push_back(std::move(buffer));
+            buffer = std::vector<tape_word_t>();
+            if (spare.size() > maxSpareCount)
+            {
+                // Drop the smallest spare buffer.
+                auto smallest = std::min_element(spare.begin(), spare.end(),
+                    [](const std::vector<tape_word_t>& a, const std::vector<tape_word_t>& b) { return a.capacity() < b.capacity(); });
+                TapeMemoryCounter() -= Bytes(*smallest);
+                spareBytes -= Bytes(*smallest);
+                spare.erase(smallest);
+            }
+        }
+
+        void trim()
+        {
+            TapeMemoryCounter() -= spareBytes;
+            spareBytes = 0;
+            spare.clear();
+        }
+
+        std::size_t getUsedBytes() const
+        {
+            return usedBytes;
+        }
+
+        std::size_t getSpareBytes() const
+        {
+            return spareBytes;
+        }
+    };
+
+
     class TapeLoop
     {
     private:
         static constexpr int windowSize = 3;
-        using sinc_interpolator_t = Interpolator<float, windowSize>;
+        static constexpr int growthHeadroom = 1024;    // samples: start growing this far ahead of need
+        using sinc_interpolator_t = PolyphaseInterpolator<float, windowSize>;
 
         float delayTimeSec = 0;
         float sampleRateHz = 0;
         double reversePlaybackHead = 0;
         int recordIndex = 0;
-        std::vector<float> buffer;
+        std::vector<tape_word_t> buffer;
         int bufferLength = 0;
+        int maxBufferLength = 0;
+        float coveredDelaySec = -1;     // the tape is known to be long enough for delay times up to this
+        TapeLoopPool* pool = nullptr;
+        TapeStorage storage = TapeStorage::Default;
         unsigned recoveryCountdown = 0;
         TapeDelayMotor tapeDelayMotor;
+        ControlRateInterpolator<1> motorControl;    // runs the motor every few samples when requested
         InterpolatorKind ikind = InterpolatorKind::Linear;
 
         int wrapIndex(int position) const
         {
-            const int length = static_cast<int>(buffer.size());
+            // Reads are never more than one buffer length away from the valid range,
+            // so a single conditional add or subtract almost always does the job.
+            const int length = bufferLength;
+            if (position < 0)
+                position += length;
+            else if (position >= length)
+                position -= length;
+
+            if (static_cast<unsigned>(position) < static_cast<unsigned>(length))
+                return position;
+
             return MOD(position, length);
         }
 
-        const float& at(int position) const         // allowed to wrap around in +/- directions
+        float wrapTime(float secondsIntoPast) const
         {
-            return buffer[wrapIndex(position)];
+            // Same as FMOD(secondsIntoPast, delayTimeSec), but skips the
+            // division when the time is already in range.
+            if (secondsIntoPast >= 0 && secondsIntoPast < delayTimeSec)
+                return secondsIntoPast;
+            return FMOD(secondsIntoPast, delayTimeSec);
         }
 
-        float& at(int position)
+        int wordsPerSample() const
         {
-            return buffer[wrapIndex(position)];
+            return (storage == TapeStorage::Float32) ? 2 : 1;
+        }
+
+        float load(int index) const
+        {
+            switch (storage)
+            {
+            case TapeStorage::Float16:
+                return HalfToFloat(buffer[index]);
+
+            case TapeStorage::Int16:
+                return Int16ToFloat(static_cast<int16_t>(buffer[index]));
+
+            default:
+                {
+                    float x;
+                    std::memcpy(&x, &buffer[2*index], sizeof(x));
+                    return x;
+                }
+            }
+        }
+
+        void store(int index, float x)
+        {
+            switch (storage)
+            {
+            case TapeStorage::Float16:
+                buffer[index] = FloatToHalf(x);
+                break;
+
+            case TapeStorage::Int16:
+                buffer[index] = static_cast<tape_word_t>(FloatToInt16(x));
+                break;
+
+            default:
+                std::memcpy(&buffer[2*index], &x, sizeof(x));
+                break;
+            }
+        }
+
+        void loadGathered(const int* index, float* y, int n) const
+        {
+            // Same as y[i] = load(index[i]), but converts 16-bit samples 4 at a time.
+            constexpr int maxCount = 64;
+            assert(n <= maxCount);
+            tape_word_t w[maxCount];
+            int i = 0;
+            switch (storage)
+            {
+            case TapeStorage::Float16:
+                for (int k = 0; k < n; ++k)
+                    w[k] = buffer[index[k]];
+                for (; i+4 <= n; i += 4)
+                    HalfToFloat4(w + i, y + i);
+                break;
+
+            case TapeStorage::Int16:
+                for (int k = 0; k < n; ++k)
+                    w[k] = buffer[index[k]];
+                for (; i+4 <= n; i += 4)
+                    Int16ToFloat4(reinterpret_cast<const int16_t*>(w + i), y + i);
+                break;
+
+            default:
+                for (; i < n; ++i)
+                    std::memcpy(&y[i], &buffer[2*index[i]], sizeof(float));
+                break;
+            }
+            for (; i < n; ++i)
+                y[i] = load(index[i]);
+        }
+
+        void loadRun(int index, float* y, int n) const
+        {
+            // Same as y[i] = load(index+i) for i = 0..n-1, without wrapping around.
+            int i = 0;
+            switch (storage)
+            {
+            case TapeStorage::Float16:
+                for (; i+4 <= n; i += 4)
+                    HalfToFloat4(&buffer[index + i], y + i);
+                break;
+
+            case TapeStorage::Int16:
+                for (; i+4 <= n; i += 4)
+                    Int16ToFloat4(reinterpret_cast<const int16_t*>(&buffer[index + i]), y + i);
+                break;
+
+            default:
+                std::memcpy(y, &buffer[2*index], n * sizeof(float));
+                i = n;
+                break;
+            }
+            for (; i < n; ++i)
+                y[i] = load(index + i);
+        }
+
+        void storeRun(int index, const float* x, int n)
+        {
+            // Same as store(index+i, x[i]) for i = 0..n-1, without wrapping around.
+            int i = 0;
+            switch (storage)
+            {
+            case TapeStorage::Float16:
+                for (; i+4 <= n; i += 4)
+                    FloatToHalf4(x + i, &buffer[index + i]);
+                break;
+
+            case TapeStorage::Int16:
+                for (; i+4 <= n; i += 4)
+                    FloatToInt164(x + i, reinterpret_cast<int16_t*>(&buffer[index + i]));
+                break;
+
+            default:
+                std::memcpy(&buffer[2*index], x, n * sizeof(float));
+                i = n;
+                break;
+            }
+            for (; i < n; ++i)
+                store(index + i, x[i]);
+        }
+
+        float at(int position) const    // allowed to wrap around in +/- directions
+        {
+            return load(wrapIndex(position));
         }
 
         float interpolate(float secondsIntoPast) const
         {
-            float index = recordIndex - (secondsIntoPast * sampleRateHz);
-            int position = static_cast<int>(std::round(index));
-            float offset = index - position;
+            return interpolateAt(recordIndex, secondsIntoPast * sampleRateHz);
+        }
+
+        void gatherLinear(int record, float samplesIntoPast, int& ic, int& in, float& offset) const
+        {
+            // Find the buffer indexes of the two samples that linear interpolation blends
+            // at `samplesIntoPast` before `record`, and the fraction of the way from `ic` to `in`.
+            // Measuring from the record index in whole samples keeps the result the same
+            // no matter where in the buffer the record index happens to be.
+            const float whole = std::round(samplesIntoPast);
+            const int position = record - static_cast<int>(whole);
+            offset = whole - samplesIntoPast;
             assert(std::abs(offset) <= 0.501);
+            ic = wrapIndex(position);
+            if (offset >= 0)
+            {
+                in = wrapIndex(position+1);
+            }
+            else
+            {
+                in = wrapIndex(position-1);
+                offset = -offset;
+            }
+        }
 
+        float interpolateAt(int record, float samplesIntoPast) const
+        {
             switch (ikind)
             {
                 case InterpolatorKind::Linear:
                 default:
                 {
-                    float yc = at(position);    // center signal
-                    float yn;   // next signal, in direction of `offset`
-                    if (offset >= 0)
-                    {
-                        yn = at(position+1);
-                    }
-                    else
-                    {
-                        yn = at(position-1);
-                        offset = -offset;       // toggle sign to force positive
-                    }
+                    int ic;         // index of center signal
+                    int in;         // index of next signal, in direction of the offset
+                    float offset;   // always positive
+                    gatherLinear(record, samplesIntoPast, ic, in, offset);
+                    const float yc = load(ic);
+                    const float yn = load(in);
                     return (1-offset)*yc + offset*yn;
                 }
 
                 case InterpolatorKind::Sinc:
                 {
+                    const float whole = std::round(samplesIntoPast);
+                    const int position = record - static_cast<int>(whole);
+                    const float offset = whole - samplesIntoPast;
+                    assert(std::abs(offset) <= 0.501);
+
                     sinc_interpolator_t interp;
                     for (int w = -windowSize; w <= +windowSize; ++w)
                         interp.write(w, at(position + w));
@@ -142,25 +568,199 @@ namespace Sapphire
             }
         }
 
+        void releaseWords()
+        {
+            if (pool)
+            {
+                pool->release(buffer);
+            }
+            else
+            {
+                TapeMemoryCounter() -= memoryBytes();
+                buffer = std::vector<tape_word_t>();
+            }
+        }
+
+        void releaseBuffer()
+        {
+            releaseWords();
+            bufferLength = 0;
+            recordIndex = 0;
+            coveredDelaySec = -1;
+        }
+
+        std::vector<tape_word_t> acquireWords(std::size_t count)
+        {
+            if (pool)
+                return pool->acquire(count);
+
+            std::vector<tape_word_t> words(count);
+            TapeMemoryCounter() += words.capacity() * sizeof(tape_word_t);
+            return words;
+        }
+
+        void growBuffer(int length)
+        {
+            // Copy the recorded audio into the bigger buffer, oldest sample first,
+            // so that every sample keeps the same age and playback continues without a click.
+            // The extra space represents audio older than anything recorded, so it is silent.
+            // This allocates and copies on the audio thread; see reserve() for how that cost is spread out.
+            const int wps = wordsPerSample();
+            std::vector<tape_word_t> grown = acquireWords(static_cast<std::size_t>(length) * wps);
+            std::copy(buffer.begin() + recordIndex*wps, buffer.begin() + bufferLength*wps, grown.begin());
+            std::copy(buffer.begin(), buffer.begin() + recordIndex*wps, grown.begin() + (bufferLength - recordIndex)*wps);
+            std::fill(grown.begin() + bufferLength*wps, grown.end(), 0);
+            const int record = bufferLength;
+            releaseBuffer();
+            buffer = std::move(grown);
+            bufferLength = length;
+            recordIndex = record;
+        }
+
+        void reserve(float delaySec)
+        {
+            // Make sure the tape is long enough for every read at this delay time,
+            // including the crossover region and the interpolator window.
+            if (delaySec <= coveredDelaySec)
+                return;
+
+            // Growing allocates and copies the whole tape, so loops that share a pool take turns:
+            // each frame, only one of them can grow before it strictly has to.
+            // The tape motor moves the playback head less than one sample per frame,
+            // so starting `growthHeadroom` samples early leaves plenty of frames to wait for a turn.
+            // The first buffer after initialization or a sample rate change cannot wait,
+            // so all the loops in a pool still allocate that one on the same frame.
+            const int margin = windowSize + 2;
+            const int required = std::min(maxBufferLength, static_cast<int>(std::ceil(sampleRateHz * (delaySec + TAPELOOP_CROSSOVER_SECONDS))) + margin);
+            const int wanted = std::min(maxBufferLength, required + growthHeadroom);
+            const bool urgent = (required > bufferLength);
+            if (wanted > bufferLength && (urgent || pool == nullptr || pool->claimGrowth()))
+            {
+                // Grow geometrically so a slowly increasing delay time causes only a few reallocations.
+                const int minimum = static_cast<int>(std::ceil(sampleRateHz * TAPELOOP_MIN_TAPE_SECONDS));
+                growBuffer(std::min(maxBufferLength, std::max({wanted, bufferLength + bufferLength/4, minimum})));
+            }
+
+            // Remember how far the tape reaches before it should grow again,
+            // leaving a sample to spare for roundoff, so most calls can skip the calculation above.
+            if (bufferLength == maxBufferLength)
+                coveredDelaySec = TAPELOOP_MAX_DELAY_SECONDS;
+            else
+                coveredDelaySec = (bufferLength - growthHeadroom - margin - 1) / sampleRateHz - TAPELOOP_CROSSOVER_SECONDS;
+        }
+
     public:
         explicit TapeLoop()
         {
             initialize();
         }
 
+        ~TapeLoop()
+        {
+            releaseBuffer();
+        }
+
+        TapeLoop(const TapeLoop&) = delete;
+        TapeLoop& operator = (const TapeLoop&) = delete;
+
+        void setPool(TapeLoopPool* _pool)
+        {
+            // Recycle tape buffers through `_pool`, which may be shared with other loops.
+            // Changing the pool erases the tape.
+            if (pool != _pool)
+            {
+                releaseBuffer();
+                pool = _pool;
+            }
+        }
+
+        std::size_t memoryBytes() const
+        {
+            // The memory used by this loop's tape.
+            return buffer.capacity() * sizeof(tape_word_t);
+        }
+
+        static std::size_t TotalMemoryBytes()
+        {
+            // The memory used by the tapes of every TapeLoop in the process,
+            // including spare buffers held by pools.
+            return TapeMemoryCounter();
+        }
+
         void initialize()
         {
             recordIndex = 0;
             reversePlaybackHead = 0;
             recoveryCountdown = 0;
             tapeDelayMotor.initialize();
+            motorControl.initialize();
             clear();
         }
 
         void clear()
         {
-            for (float& x : buffer)
-                x = 0;
+            // All-zero words are silence in every storage format.
+            std::fill(buffer.begin(), buffer.end(), 0);
+        }
+
+        TapeStorage getStorage() const
+        {
+            return storage;
+        }
+
+        void setStorage(TapeStorage _storage)
+        {
+            // Convert the recorded audio to the new format, keeping its place on the tape.
+            // The conversion runs in place, a chunk at a time, whenever the buffer is big enough.
+            // Narrowing to 16 bits always is, so the tape keeps its allocation until it next grows.
+            // Widening needs a bigger buffer only when this tape was never 32 bits wide.
+            if (storage == _storage)
+                return;
+
+            const TapeStorage prev = storage;
+            const int length = bufferLength;
+            constexpr int chunk = 64;
+            float x[chunk];
+            if (_storage != TapeStorage::Float32)
+            {
+                // Each chunk is read before it is written, and is never written
+                // beyond where later chunks are read from, so convert front to back.
+                for (int start = 0; start < length; start += chunk)
+                {
+                    const int n = std::min(chunk, length - start);
+                    storage = prev;
+                    loadRun(start, x, n);
+                    storage = _storage;
+                    storeRun(start, x, n);
+                }
+                storage = _storage;
+                buffer.resize(length);
+            }
+            else if (buffer.capacity() >= 2 * static_cast<std::size_t>(length))
+            {
+                // Widening moves every sample to a higher position, so convert back to front.
+                buffer.resize(2 * static_cast<std::size_t>(length));
+                for (int end = length; end > 0; end -= chunk)
+                {
+                    const int n = std::min(chunk, end);
+                    loadRun(end - n, x, n);
+                    std::memcpy(&buffer[2*(end - n)], x, n * sizeof(float));
+                }
+                storage = _storage;
+            }
+            else
+            {
+                std::vector<tape_word_t> wide = acquireWords(2 * static_cast<std::size_t>(length));
+                for (int start = 0; start < length; start += chunk)
+                {
+                    const int n = std::min(chunk, length - start);
+                    loadRun(start, x, n);
+                    std::memcpy(&wide[2*start], x, n * sizeof(float));
+                }
+                releaseWords();
+                buffer = std::move(wide);
+                storage = _storage;
+            }
         }
 
         bool isRecoveringFromOverload() const
@@ -183,6 +783,16 @@ namespace Sapphire
             tapeDelayMotor.setSlewRate(_slewRate);
         }
 
+        void setControlRate(ControlRate rate)
+        {
+            motorControl.setInterval(ControlRateInterval(rate));
+        }
+
+        float getDelayTime() const
+        {
+            return delayTimeSec;
+        }
+
         bool setDelayTime(float _delayTimeSec, float _sampleRateHz)
         {
             if (!std::isfinite(_delayTimeSec))
@@ -194,28 +804,37 @@ namespace Sapphire
             if (sampleRateHz != _sampleRateHz)
             {
                 // The first time we know the sample rate, or any time it changes,
-                // resize the buffer to allow the maximum possible number of samples
-                // as required by the new sample rate.
-
-                sampleRateHz = _sampleRateHz;
+                // calculate the largest the tape can ever need to be.
+                // The tape starts out empty and grows as the delay time requires.
 
                 const float maxTime = TAPELOOP_MAX_DELAY_SECONDS + TAPELOOP_CROSSOVER_SECONDS;
                 const int maxSamples = static_cast<int>(std::ceil(_sampleRateHz * maxTime));
                 if (maxSamples <= 0)
                     return false;
 
-                bufferLength = maxSamples;
-                buffer.resize(bufferLength);
-                clear();    // any audio in the buffer already is recorded at the wrong sample rate
+                sampleRateHz = _sampleRateHz;
+                maxBufferLength = maxSamples;
+                releaseBuffer();    // any audio in the buffer already is recorded at the wrong sample rate
             }
 
-            delayTimeSec = tapeDelayMotor.process(_delayTimeSec, _sampleRateHz);
+            // The motor's slew limit is per second, so running it at a lower rate
+            // and interpolating keeps the same maximum tape speed.
+            if (motorControl.isDue())
+            {
+                const int interval = motorControl.getInterval();
+                motorControl.push({tapeDelayMotor.process(_delayTimeSec, _sampleRateHz / interval)});
+            }
+            delayTimeSec = motorControl.process()[0];
+            reserve(delayTimeSec);
             return true;
         }
 
         float recall(float secondsIntoPast) const
         {
-            const float offsetSeconds = FMOD(secondsIntoPast, delayTimeSec);
+            const float offsetSeconds = wrapTime(secondsIntoPast);
+            if (offsetSeconds == 0)
+                return interpolate(delayTimeSec);   // the crossover mix would be 100% older data
+
             float newer = interpolate(offsetSeconds);
             if (offsetSeconds >= TAPELOOP_CROSSOVER_SECONDS)
                 return newer;
@@ -236,7 +855,11 @@ namespace Sapphire
         void updateReversePlaybackHead()
         {
             const double incr = 2.0 / static_cast<double>(sampleRateHz);
-            reversePlaybackHead = FMOD<double>(reversePlaybackHead + incr, delayTimeSec);
+            const double head = reversePlaybackHead + incr;
+            if (head >= 0 && head < delayTimeSec)
+                reversePlaybackHead = head;
+            else
+                reversePlaybackHead = FMOD<double>(head, delayTimeSec);
         }
 
 
@@ -267,9 +890,138 @@ namespace Sapphire
                     recoveryCountdown = 48000;
             }
 
-            buffer[recordIndex] = safe * clearSmootherGain;
-            recordIndex = (recordIndex + 1) % bufferLength;
+            store(recordIndex, safe * clearSmootherGain);
+            if (++recordIndex == bufferLength)
+                recordIndex = 0;
             return recoveryCountdown == 0;
         }
+
+        // Block operations.
+        // Forward playback always reads at least TAPELOOP_MIN_DELAY_SECONDS into the past,
+        // so a block of frames can be read before any of them are recorded.
+        // Calling readForwardBlock and then writeBlock for the same `nframes` is equivalent to calling
+        // setDelayTime, readForward, and write for each frame, as long as nframes <= MaxBlockLength(sampleRateHz).
+
+        static int MaxBlockLength(float sampleRateHz)
+        {
+            const int margin = windowSize + 2;      // farthest an interpolator reads past its center sample
+            return std::max(1, static_cast<int>(TAPELOOP_MIN_DELAY_SECONDS * sampleRateHz) - margin);
+        }
+
+        void readForwardBlock(float requestedDelayTimeSec, float requestSampleRateHz, float* output, int nframes)
+        {
+            constexpr int chunk = 64;
+            float back[chunk];
+            int record[chunk];
+            for (int start = 0; start < nframes; start += chunk)
+            {
+                const int n = std::min(chunk, nframes - start);
+
+                // Run the tape motor first: the tape can grow while it speeds up.
+                for (int i = 0; i < n; ++i)
+                {
+                    setDelayTime(requestedDelayTimeSec, requestSampleRateHz);
+                    back[i] = delayTimeSec * sampleRateHz;
+                }
+
+                // The record head moves one sample per frame, and wraps around
+                // the end of the buffer at most once in the block.
+                int r = recordIndex + start;
+                for (int i = 0; i < n; ++i, ++r)
+                {
+                    if (r >= bufferLength)
+                        r -= bufferLength;
+                    record[i] = r;
+                }
+
+                float *out = output + start;
+                if (bufferLength == 0)
+                {
+                    std::fill(out, out + n, 0.0f);
+                }
+                else if (ikind == InterpolatorKind::Sinc)
+                {
+                    for (int i = 0; i < n; ++i)
+                        out[i] = interpolateAt(record[i], back[i]);
+                }
+                else
+                {
+                    int ic[chunk], in[chunk];
+                    float yc[chunk], yn[chunk], offset[chunk];
+                    for (int i = 0; i < n; ++i)
+                        gatherLinear(record[i], back[i], ic[i], in[i], offset[i]);
+                    loadGathered(ic, yc, n);
+                    loadGathered(in, yn, n);
+
+                    const __m128 one = _mm_set1_ps(1.0f);
+                    int i = 0;
+                    for (; i+4 <= n; i += 4)
+                    {
+                        const __m128 f = _mm_loadu_ps(offset + i);
+                        const __m128 a = _mm_mul_ps(_mm_sub_ps(one, f), _mm_loadu_ps(yc + i));
+                        const __m128 b = _mm_mul_ps(f, _mm_loadu_ps(yn + i));
+                        _mm_storeu_ps(out + i, _mm_add_ps(a, b));
+                    }
+                    for (; i < n; ++i)
+                        out[i] = (1-offset[i])*yc[i] + offset[i]*yn[i];
+                }
+            }
+        }
+
+        bool writeBlock(const float* input, int nframes, float clearSmootherGain)
+        {
+            // Returns false if the loop is recovering from an overload after any frame.
+            // Frames that were already read for this block are not affected by the resulting clear().
+            constexpr int chunk = 64;
+            float safe[chunk];
+            bool happy = true;
+            for (int start = 0; start < nframes; start += chunk)
+            {
+                const int n = std::min(chunk, nframes - start);
+                const float* in = input + start;
+
+                // Apply the same protection as write() before converting any samples.
+                for (int i = 0; i < n; ++i)
+                {
+                    float s = 0;
+                    if (recoveryCountdown > 0)
+                    {
+                        --recoveryCountdown;
+                    }
+                    else if (std::isfinite(in[i]) && std::abs(in[i]) <= TAPELOOP_RECORD_VOLTAGE_LIMIT)
+                    {
+                        s = in[i];
+                    }
+                    else
+                    {
+                        // Erase the tape, including the samples in this chunk that are not stored yet.
+                        clear();
+                        std::fill(safe, safe + i, 0.0f);
+                        if (IsValidSampleRate(sampleRateHz))
+                            recoveryCountdown = static_cast<unsigned>(sampleRateHz);
+                        else
+                            recoveryCountdown = 48000;
+                    }
+                    safe[i] = s * clearSmootherGain;
+                    if (recoveryCountdown > 0)
+                        happy = false;
+                }
+
+                // Store the chunk, wrapping around the end of the tape at most once.
+                int remaining = n;
+                const float* x = safe;
+                while (remaining > 0 && bufferLength > 0)
+                {
+                    const int m = std::min(remaining, bufferLength - recordIndex);
+                    storeRun(recordIndex, x, m);
+                    x += m;
+                    remaining -= m;
+                    recordIndex += m;
+                    if (recordIndex == bufferLength)
+                        recordIndex = 0;
+                }
+            }
+            return happy;
+        }
     };
 }
@@ -81,5 +81,88 @@ namespace Sapphire
                 return result;
             }
         };
+
+
+        class QuadGravyEngine
+        {
+            // Four SingleChannelGravyEngine<float> instances, one per SIMD lane,
+            // each with its own knob settings.
+            // With FilterTanMode::Exact, every lane produces exactly the same output as SingleChannelGravyEngine<float>.
+
+        private:
+            PhysicsVector freqKnob  = DefaultFrequencyKnob;
+            PhysicsVector resKnob   = DefaultResonanceKnob;
+            PhysicsVector mixKnob   = DefaultMixKnob;
+            PhysicsVector gainKnob  = DefaultGainKnob;
+
+            QuadStateVariableFilter filter;
+
+            static void setKnob(float &v, float k, int lo = 0, int hi = 1)
+            {
+                if (std::isfinite(k))
+                    v = ClampInt(k, lo, hi);
+            }
+
+        public:
+            float centerFrequencyHz = DefaultFrequencyHz;
+            int minOctave = -OctaveRange;
+            int maxOctave = +OctaveRange;
+
+            QuadGravyEngine()
+            {
+                initialize();
+            }
+
+            void initialize()
+            {
+                filter.initialize();
+            }
+
+            void setTanMode(FilterTanMode mode)
+            {
+                filter.setTanMode(mode);
+            }
+
+            void setFrequency(int lane, float k)
+            {
+                setKnob(freqKnob[lane], k, minOctave, maxOctave);
+            }
+
+            void setResonance(int lane, float k)
+            {
+                setKnob(resKnob[lane], k);
+            }
+
+            void setMix(int lane, float k)
+            {
+                setKnob(mixKnob[lane], k);
+            }
+
+            void setGain(int lane, float k)
+            {
+                setKnob(gainKnob[lane], k);
+            }
+
+            FilterResult<PhysicsVector> process(float sampleRateHz, const PhysicsVector& inSample)
+            {
+                PhysicsVector cornerFreqHz;
+                PhysicsVector gain;
+                PhysicsVector mix;
+                for (int i = 0; i < 4; ++i)
+                {
+                    cornerFreqHz[i] = TwoToPower(freqKnob[i]) * centerFrequencyHz;
+                    gain[i] = Cube(gainKnob[i] * 2);
+                    mix[i] = SingleChannelGravyEngine<float>::MixFactor(mixKnob[i]);
+                }
+
+                FilterResult<PhysicsVector> result = filter.process(sampleRateHz, cornerFreqHz, resKnob, inSample);
+                result.lowpass  = gain * (mix*result.lowpass  + (1-mix)*inSample);
+                result.bandpass = gain * (mix*result.bandpass + (1-mix)*inSample);
+                result.highpass = gain * (mix*result.highpass + (1-mix)*inSample);
+                result.notch = result.lowpass + result.highpass;
+
+                return result;
+            }
+        };
     }
 }
@@ -50,7 +50,9 @@ namespace Sapphire
 
         struct SauceModule : SapphireModule
         {
-            Gravy::SingleChannelGravyEngine<float> engine[PORT_MAX_CHANNELS];
+            static constexpr int NQUADS = PORT_MAX_CHANNELS / 4;
+            Gravy::QuadGravyEngine engine[NQUADS];      // 4 channels per engine
+            FilterTanMode tanMode = FilterTanMode::Default;
             AutomaticGainLimiter agcLow;
             AutomaticGainLimiter agcBand;
             AutomaticGainLimiter agcHigh;
@@ -94,11 +96,25 @@ namespace Sapphire
 
             void initialize()
             {
-                for (int c = 0; c < PORT_MAX_CHANNELS; ++c)
-                    engine[c].initialize();
+                for (int q = 0; q < NQUADS; ++q)
+                    engine[q].initialize();
+                tanMode = FilterTanMode::Default;
                 reflectAgcSlider();
             }
 
+            json_t* dataToJson() override
+            {
+                json_t* root = SapphireModule::dataToJson();
+                jsonSetEnum(root, "tanMode", tanMode);
+                return root;
+            }
+
+            void dataFromJson(json_t* root) override
+            {
+                SapphireModule::dataFromJson(root);
+                jsonLoadEnum(root, "tanMode", tanMode);
+            }
+
             bool getAgcEnabled() const { return enableAgc; }
 
             void setAgcEnabled(bool enable)
@@ -185,9 +201,13 @@ namespace Sapphire
                     float cvRes = 0;
                     float cvMix = 0;
                     float cvGain = 0;
+                    PhysicsVector inFrame[NQUADS];
 
                     for (int c = 0; c < nc; ++c)
                     {
+                        const int q = c / 4;
+                        const int lane = c % 4;
+
                         nextChannelInputVoltage(input,  AUDIO_INPUT,   c);
                         nextChannelInputVoltage(cvFreq, FREQ_CV_INPUT, c);
                         nextChannelInputVoltage(cvRes,  RES_CV_INPUT,  c);
@@ -199,15 +219,24 @@ namespace Sapphire
                         float mixKnob   = cvGetControlValue(MIX_PARAM,   MIX_ATTEN,   cvMix);
                         float gainKnob  = cvGetControlValue(GAIN_PARAM,  GAIN_ATTEN,  cvGain);
 
-                        engine[c].setFrequency(freqKnob);
-                        engine[c].setResonance(resKnob);
-                        engine[c].setMix(mixKnob);
-                        engine[c].setGain(gainKnob);
+                        engine[q].setFrequency(lane, freqKnob);
+                        engine[q].setResonance(lane, resKnob);
+                        engine[q].setMix(lane, mixKnob);
+                        engine[q].setGain(lane, gainKnob);
+                        inFrame[q][lane] = input;
+                    }
 
-                        FilterResult<float> result = engine[c].process(args.sampleRate, input);
-                        lpOutput[c] = result.lowpass;
-                        bpOutput[c] = result.bandpass;
-                        hpOutput[c] = result.highpass;
+                    for (int c = 0; c < nc; c += 4)
+                    {
+                        const int q = c / 4;
+                        engine[q].setTanMode(tanMode);
+                        FilterResult<PhysicsVector> result = engine[q].process(args.sampleRate, inFrame[q]);
+                        for (int lane = 0; lane < 4 && c + lane < nc; ++lane)
+                        {
+                            lpOutput[c + lane] = result.lowpass[lane];
+                            bpOutput[c + lane] = result.bandpass[lane];
+                            hpOutput[c + lane] = result.highpass[lane];
+                        }
                     }
 
                     if (isFireDrillOneShot())
@@ -229,8 +258,8 @@ namespace Sapphire
                         clearOutput(bpOutput, PORT_MAX_CHANNELS);
                         clearOutput(hpOutput, PORT_MAX_CHANNELS);
 
-                        for (int c = 0; c < PORT_MAX_CHANNELS; ++c)
-                            engine[c].initialize();
+                        for (int q = 0; q < NQUADS; ++q)
+                            engine[q].initialize();
 
                         beginRecovery(args.sampleRate);
                     }
@@ -276,6 +305,15 @@ namespace Sapphire
                 if (sauceModule)
                 {
                     menu->addChild(sauceModule->createToggleAllSensitivityMenuItem());
+                    menu->addChild(CreateChangeEnumMenuItem(
+                        "Filter tuning",
+                        {
+                            "Exact",
+                            "Fast (uses less CPU with frequency modulation)"
+                        },
+                        "change filter tuning",
+                        sauceModule->tanMode
+                    ));
                 }
             }
         };
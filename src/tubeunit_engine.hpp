@@ -11,13 +11,92 @@ namespace Sapphire
 {
     const float TubeUnitDefaultRootFrequencyHz = 3.0f;
 
+    struct TubeUnitCoefficients
+    {
+        // Coefficients derived from (sampleRate, rootFrequency, reflectionDecay, reflectionAngle).
+        // They are expensive to calculate, so they are recalculated only when one of those inputs changes.
+
+        static const int windowSteps = 5;
+        using interp_t = Interpolator<complex_t, windowSteps>;
+        static const int windowSize = static_cast<int>(interp_t::nsamples);
+
+        float sampleRate = 0.0f;
+        float rootFrequency = 0.0f;
+        float reflectionDecay = 0.0f;
+        float reflectionAngle = 0.0f;
+        std::size_t outboundLength = 0;
+        std::size_t inboundLength = 0;
+        complex_t reflectionFraction;
+        float window[windowSize] {};
+
+        void invalidate()
+        {
+            sampleRate = 0.0f;
+        }
+
+        bool update(float _sampleRate, float _rootFrequency, float _reflectionDecay, float _reflectionAngle)
+        {
+            // Returns true if the coefficients changed, in which case the caller must
+            // update the lengths of its delay lines.
+            if (_sampleRate == sampleRate &&
+                _rootFrequency == rootFrequency &&
+                _reflectionDecay == reflectionDecay &&
+                _reflectionAngle == reflectionAngle)
+                return false;
+
+            if (_sampleRate <= 0.0f)
+                throw std::logic_error("Invalid sample rate in TubeUnitEngine");
+
+            if (_rootFrequency <= 0.0f)
+                throw std::logic_error("Invalid root frequency in TubeUnitEngine");
+
+            // A tube that is open on one end and closed on the other end has a negative
+            // reflection at the open end and a positive reflection at the closed end.
+            // Therefore a pulse has to travel the length of the tube 4 times
+            // (that is, back and forth, then back and forth again) to complete a cycle.
+            // Thus the tube must be 1/4 the length of the number of samples for a period of the root frequency.
+
+            // Divide wavelength by 2 because we have both inbound and outbound delay lines.
+            // Add extra samples needed for the interpolator window, and round up to next higher integer.
+            double roundTripSamples = (_sampleRate / (2.0 * _rootFrequency));
+
+            std::size_t nsamples = static_cast<std::size_t>(std::floor(roundTripSamples));
+            std::size_t smallerHalf = nsamples / 2;
+            std::size_t largerHalf = nsamples - smallerHalf;
+
+            if (largerHalf < windowSteps + 1)
+                throw std::logic_error("outbound delay line is not large enough for interpolation.");
+
+            outboundLength = largerHalf + windowSteps;
+            inboundLength = smallerHalf;
+
+            // Use the interpolator to handle the fractional number of samples needed
+            // to produce the exact root frequency.
+            interp_t::window(nsamples - roundTripSamples, window);
+
+            // Reflection from the open end of a tube causes the return pressure
+            // wave to be inverted.
+            // Convert the (decay, angle) pair into a complex coefficient.
+            float halflife = TenToPower((2 * _reflectionDecay) - 1);     // exponential range 0.1 seconds ... 10 seconds.
+            float magnitude = OneHalfToPower(1 / (_rootFrequency * halflife));
+            float radians = M_PI * _reflectionAngle;
+            reflectionFraction = complex_t{ magnitude * std::cos(radians), magnitude * std::sin(radians) };
+
+            sampleRate = _sampleRate;
+            rootFrequency = _rootFrequency;
+            reflectionDecay = _reflectionDecay;
+            reflectionAngle = _reflectionAngle;
+            return true;
+        }
+    };
+
     class TubeUnitEngine
     {
     private:
         float sampleRate = 0.0f;
         bool isQuiet;
-        DelayLine<complex_t> outbound;  // sends pressure waves from the mouth to the opening
-        DelayLine<complex_t> inbound;   // reflects pressure waves from the opening back to the mouth
+        Pow2DelayLine<complex_t> outbound;  // sends pressure waves from the mouth to the opening
+        Pow2DelayLine<complex_t> inbound;   // reflects pressure waves from the opening back to the mouth
         float airflow;                  // mass flow rate of air, normalized to [-1, +1].
         float rootFrequency;            // resonant frequency of tube in Hz
         complex_t mouthPressure;        // mouth chamber pressure relative to ambient atmosphere (i.e. can be negative) [Pa]
@@ -42,8 +121,7 @@ namespace Sapphire
         float mix;
         StagedFilter<complex_t, 1> dcRejectFilter;
         StagedFilter<complex_t, 1> loPassFilter;
-        static const int windowSteps = 5;
-        Interpolator<complex_t, windowSteps> interp;
+        TubeUnitCoefficients coef;
 
     public:
         TubeUnitEngine()
@@ -54,6 +132,7 @@ namespace Sapphire
         void initialize()
         {
             isQuiet = false;
+            coef.invalidate();
             outbound.clear();
             inbound.clear();
             airflow = 0.0f;
@@ -211,41 +290,18 @@ namespace Sapphire
 
         void process(float& leftOutput, float& rightOutput, float leftInput, float rightInput)
         {
-            if (sampleRate <= 0.0f)
-                throw std::logic_error("Invalid sample rate in TubeUnitEngine");
-
-            if (rootFrequency <= 0.0f)
-                throw std::logic_error("Invalid root frequency in TubeUnitEngine");
-
-            // A tube that is open on one end and closed on the other end has a negative
-            // reflection at the open end and a positive reflection at the closed end.
-            // Therefore a pulse has to travel the length of the tube 4 times
-            // (that is, back and forth, then back and forth again) to complete a cycle.
-            // Thus the tube must be 1/4 the length of the number of samples for a period of the root frequency.
-
-            // Divide wavelength by 2 because we have both inbound and outbound delay lines.
-            // Add extra samples needed for the interpolator window, and round up to next higher integer.
-            double roundTripSamples = (sampleRate / (2.0 * rootFrequency));
-
-            std::size_t nsamples = static_cast<std::size_t>(std::floor(roundTripSamples));
-            std::size_t smallerHalf = nsamples / 2;
-            std::size_t largerHalf = nsamples - smallerHalf;
-
-            if (largerHalf < windowSteps + 1)
-                throw std::logic_error("outbound delay line is not large enough for interpolation.");
-
-            outbound.setLength(largerHalf + windowSteps);
-            inbound.setLength(smallerHalf);
+            if (coef.update(sampleRate, rootFrequency, reflectionDecay, reflectionAngle))
+            {
+                outbound.setLength(coef.outboundLength);
+                inbound.setLength(coef.inboundLength);
+            }
 
-            // Copy the window of outbound samples into a sinc-interpolator.
-            for (int n = -windowSteps; n <= +windowSteps; ++n)
-                interp.write(n, outbound.readForward(n + windowSteps));
+            // Find the effective pressure the open end of the tube (the "bell"),
+            // by applying the interpolator window to the outbound samples.
+            complex_t bellPressure {};
+            for (int n = 0; n < TubeUnitCoefficients::windowSize; ++n)
+                bellPressure += outbound.readForward(n) * coef.window[n];
 
-            // Find the effective pressure the open end of the tube (the "bell").
-            // Use the interpolator to handle the fractional number of samples needed
-            // to produce the exact root frequency.
-
-            complex_t bellPressure = interp.read(nsamples - roundTripSamples);
             bellPressure = dcRejectFilter.UpdateHiPass(bellPressure, sampleRate);
 
             // The tube has two ends: the breech and the bell.
@@ -268,14 +324,7 @@ namespace Sapphire
             // Keep vibrations moving through the two waveguides (delay lines).
             outbound.write(outSignal);
 
-            // Reflection from the open end of a tube causes the return pressure
-            // wave to be inverted.
-            // Convert the (decay, angle) pair into a complex coefficient.
-            float halflife = TenToPower((2 * reflectionDecay) - 1);     // exponential range 0.1 seconds ... 10 seconds.
-            float magnitude = OneHalfToPower(1 / (rootFrequency * halflife));
-            float radians = M_PI * reflectionAngle;
-            complex_t reflectionFraction { magnitude * std::cos(radians), magnitude * std::sin(radians) };
-            inbound.write(-reflectionFraction * bellPressure);
+            inbound.write(-coef.reflectionFraction * bellPressure);
 
             if (isQuiet)
             {
@@ -337,4 +386,375 @@ namespace Sapphire
             }
         }
     };
+
+    class TubeUnitSimdEngine
+    {
+        // Runs 4 Tube Unit voices in lockstep, one per SSE lane.
+        // Each voice has its own waveguides, because their lengths depend on the voice's root frequency,
+        // but all the complex-valued state (pressures, piston motion, filters) is stored as
+        // separate real and imaginary float vectors, so every arithmetic step handles all 4 voices at once.
+        // Each voice matches TubeUnitEngine with the same settings, except for float rounding differences.
+
+    public:
+        static const int NumLanes = 4;
+
+    private:
+        float sampleRate = 0.0f;
+        bool isQuiet[NumLanes];
+        Pow2DelayLine<complex_t> outbound[NumLanes];
+        Pow2DelayLine<complex_t> inbound[NumLanes];
+        TubeUnitCoefficients coef[NumLanes];
+        AutomaticGainLimiter agc[NumLanes];
+        bool enableAgc = false;
+        float gain;
+        float mix;
+
+        // Per-voice parameters.
+        float airflow[NumLanes];
+        float rootFrequency[NumLanes];
+        float stopper1[NumLanes];
+        float stopper2[NumLanes];
+        float bypass1[NumLanes];
+        float bypass2[NumLanes];
+        float springConstant[NumLanes];
+        float reflectionDecay[NumLanes];
+        float reflectionAngle[NumLanes];
+        float vortex[NumLanes];
+
+        // Constants, the same as TubeUnitEngine.
+        static constexpr float mouthVolume = 3.0e-6;
+        static constexpr float bypassResistance = 0.1f;
+        static constexpr float pistonArea = 6.45e-4;
+        static constexpr float pistonMass = 1.0e-5;
+        static constexpr float springRestLength = -1.0f;
+
+        // Complex state, split into real and imaginary lanes.
+        float mouthPressureRe[NumLanes];
+        float mouthPressureIm[NumLanes];
+        float pistonPositionRe[NumLanes];
+        float pistonPositionIm[NumLanes];
+        float pistonSpeedRe[NumLanes];
+        float pistonSpeedIm[NumLanes];
+        float dcRejectXRe[NumLanes];
+        float dcRejectXIm[NumLanes];
+        float dcRejectYRe[NumLanes];
+        float dcRejectYIm[NumLanes];
+        float loPassXRe[NumLanes];
+        float loPassXIm[NumLanes];
+        float loPassYRe[NumLanes];
+        float loPassYIm[NumLanes];
+
+        static __m128 load(const float *x)
+        {
+            return _mm_loadu_ps(x);
+        }
+
+        static void store(float *x, __m128 v)
+        {
+            _mm_storeu_ps(x, v);
+        }
+
+        static __m128 select(__m128 mask, __m128 a, __m128 b)
+        {
+            // Returns `a` in lanes where `mask` is set, and `b` elsewhere.
+            return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+        }
+
+        static void filterUpdate(__m128 c, __m128 xRe, __m128 xIm, float *xprevRe, float *xprevIm, float *yprevRe, float *yprevIm)
+        {
+            // Same as LoHiPassFilter::Update, for 4 complex values.
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 k = _mm_sub_ps(one, c);
+            const __m128 d = _mm_add_ps(one, c);
+            store(yprevRe, _mm_div_ps(_mm_sub_ps(_mm_add_ps(xRe, load(xprevRe)), _mm_mul_ps(load(yprevRe), k)), d));
+            store(yprevIm, _mm_div_ps(_mm_sub_ps(_mm_add_ps(xIm, load(xprevIm)), _mm_mul_ps(load(yprevIm), k)), d));
+            store(xprevRe, xRe);
+            store(xprevIm, xIm);
+        }
+
+    public:
+        TubeUnitSimdEngine()
+        {
+            initialize();
+        }
+
+        void initialize()
+        {
+            for (int lane = 0; lane < NumLanes; ++lane)
+                initialize(lane);
+            setAgcEnabled(true);
+            setGain();
+            setMix();
+        }
+
+        void initialize(int lane)
+        {
+            // Reset a single voice, the same way TubeUnitEngine::initialize does.
+            isQuiet[lane] = false;
+            coef[lane].invalidate();
+            outbound[lane].clear();
+            inbound[lane].clear();
+            agc[lane].initialize();
+            airflow[lane] = 0.0f;
+            rootFrequency[lane] = TubeUnitDefaultRootFrequencyHz;
+            stopper1[lane] = -10.0f;
+            stopper2[lane] = +10.0f;
+            bypass1[lane] = +7.0f;
+            bypass2[lane] = +8.0f;
+            springConstant[lane] = 0.503f;
+            reflectionDecay[lane] = 0.5f;
+            reflectionAngle[lane] = 0.87f;
+            vortex[lane] = 0.0f;
+            mouthPressureRe[lane] = mouthPressureIm[lane] = 0.0f;
+            pistonPositionRe[lane] = pistonPositionIm[lane] = 0.0f;
+            pistonSpeedRe[lane] = pistonSpeedIm[lane] = 0.0f;
+            dcRejectXRe[lane] = dcRejectXIm[lane] = dcRejectYRe[lane] = dcRejectYIm[lane] = 0.0f;
+            loPassXRe[lane] = loPassXIm[lane] = loPassYRe[lane] = loPassYIm[lane] = 0.0f;
+        }
+
+        bool getQuiet(int lane) const { return isQuiet[lane]; }
+        void setQuiet(int lane, bool q) { isQuiet[lane] = q; }
+
+        void setSampleRate(float sampleRateHz)
+        {
+            sampleRate = sampleRateHz;
+        }
+
+        void setRootFrequency(int lane, float rootFrequencyHz)
+        {
+            rootFrequency[lane] = std::clamp(rootFrequencyHz, 1.0f, 10000.0f);
+        }
+
+        void setAirflow(int lane, float airflowMassRate)
+        {
+            airflow[lane] = std::clamp(airflowMassRate, -1.0f, +10.0f);
+        }
+
+        void setSpringConstant(int lane, float k)
+        {
+            springConstant[lane] = std::clamp(k, 1.0e-6f, 1.0e+6f);
+        }
+
+        void setReflectionDecay(int lane, float decay)
+        {
+            reflectionDecay[lane] = decay;
+        }
+
+        void setReflectionAngle(int lane, float angle)
+        {
+            reflectionAngle[lane] = angle;
+        }
+
+        void setBypassWidth(int lane, float width)
+        {
+            float center = (bypass1[lane] + bypass2[lane]) / 2;
+            float dilate = std::clamp(width/2, 0.01f, stopper2[lane] - stopper1[lane]);
+            bypass1[lane] = center - dilate;
+            bypass2[lane] = center + dilate;
+        }
+
+        void setBypassCenter(int lane, float center)
+        {
+            float dilate = (bypass2[lane] - bypass1[lane]) / 2;
+            float clampedCenter = std::clamp(center, stopper1[lane], stopper2[lane]);
+            bypass1[lane] = clampedCenter - dilate;
+            bypass2[lane] = clampedCenter + dilate;
+        }
+
+        void setVortex(int lane, float v)
+        {
+            vortex[lane] = v;
+        }
+
+        bool getAgcEnabled() const
+        {
+            return enableAgc;
+        }
+
+        void setAgcEnabled(bool enable)
+        {
+            if (enable && !enableAgc)
+                for (int lane = 0; lane < NumLanes; ++lane)
+                    agc[lane].initialize();
+            enableAgc = enable;
+        }
+
+        void setAgcLevel(float level)
+        {
+            for (int lane = 0; lane < NumLanes; ++lane)
+                agc[lane].setCeiling(level);
+        }
+
+        double getAgcDistortion(int lane) const
+        {
+            return enableAgc ? (agc[lane].getFollower() - 1.0) : 0.0;
+        }
+
+        void setGain(float slider = 1.0f)
+        {
+            gain = std::pow(std::clamp(slider, 0.0f, 2.0f), 4.0f) / 80.0f;
+        }
+
+        void setMix(float slider = 1.0f)
+        {
+            mix = std::clamp(slider, 0.0f, 1.0f);
+        }
+
+        void process(float leftOutput[NumLanes], float rightOutput[NumLanes], const float leftInput[NumLanes], const float rightInput[NumLanes])
+        {
+            // Gather the samples each voice needs from its own waveguides.
+            float breechRe[NumLanes], breechIm[NumLanes];
+            float windowLanes[TubeUnitCoefficients::windowSize][NumLanes];
+            float outboundRe[TubeUnitCoefficients::windowSize][NumLanes];
+            float outboundIm[TubeUnitCoefficients::windowSize][NumLanes];
+            float reflectRe[NumLanes], reflectIm[NumLanes];
+            float quietMask[NumLanes];
+            for (int lane = 0; lane < NumLanes; ++lane)
+            {
+                TubeUnitCoefficients& c = coef[lane];
+                if (c.update(sampleRate, rootFrequency[lane], reflectionDecay[lane], reflectionAngle[lane]))
+                {
+                    outbound[lane].setLength(c.outboundLength);
+                    inbound[lane].setLength(c.inboundLength);
+                }
+
+                for (int n = 0; n < TubeUnitCoefficients::windowSize; ++n)
+                {
+                    const complex_t x = outbound[lane].readForward(n);
+                    outboundRe[n][lane] = x.real();
+                    outboundIm[n][lane] = x.imag();
+                    windowLanes[n][lane] = c.window[n];
+                }
+
+                const complex_t breech = inbound[lane].readForward(0);
+                breechRe[lane] = breech.real();
+                breechIm[lane] = breech.imag();
+                reflectRe[lane] = -c.reflectionFraction.real();
+                reflectIm[lane] = -c.reflectionFraction.imag();
+                quietMask[lane] = isQuiet[lane] ? 1.0f : 0.0f;
+            }
+
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 rate = _mm_set1_ps(sampleRate);
+            const __m128 quiet = _mm_cmpgt_ps(load(quietMask), zero);
+
+            // Find the effective pressure at the open end of the tube (the "bell").
+            __m128 bRe = zero;
+            __m128 bIm = zero;
+            for (int n = 0; n < TubeUnitCoefficients::windowSize; ++n)
+            {
+                const __m128 w = load(windowLanes[n]);
+                bRe = _mm_add_ps(bRe, _mm_mul_ps(load(outboundRe[n]), w));
+                bIm = _mm_add_ps(bIm, _mm_mul_ps(load(outboundIm[n]), w));
+            }
+
+            // DC reject filter: high pass at 10 Hz.
+            filterUpdate(_mm_set1_ps(static_cast<float>(sampleRate / (M_PI * 10.0f))), bRe, bIm, dcRejectXRe, dcRejectXIm, dcRejectYRe, dcRejectYIm);
+            bRe = _mm_sub_ps(load(dcRejectXRe), load(dcRejectYRe));
+            bIm = _mm_sub_ps(load(dcRejectXIm), load(dcRejectYIm));
+
+            const __m128 brRe = load(breechRe);
+            const __m128 brIm = load(breechIm);
+            const __m128 posRe = load(pistonPositionRe);
+            const __m128 posIm = load(pistonPositionIm);
+            __m128 mpRe = load(mouthPressureRe);
+            __m128 mpIm = load(mouthPressureIm);
+
+            // How much the bypass valve is open, based on the piston position.
+            const __m128 b1 = load(bypass1);
+            const __m128 fraction = _mm_min_ps(one, _mm_max_ps(zero, _mm_div_ps(_mm_sub_ps(posRe, b1), _mm_sub_ps(load(bypass2), b1))));
+            const __m128 flowScale = _mm_mul_ps(fraction, _mm_set1_ps(bypassResistance));
+            const __m128 flowRe = _mm_mul_ps(flowScale, _mm_sub_ps(mpRe, brRe));
+            const __m128 flowIm = _mm_mul_ps(flowScale, _mm_sub_ps(mpIm, brIm));
+
+            const __m128 five = _mm_set1_ps(5.0f);
+            const __m128 outRe = _mm_add_ps(_mm_add_ps(brRe, flowRe), _mm_andnot_ps(quiet, _mm_mul_ps(five, load(leftInput))));
+            const __m128 outIm = _mm_add_ps(_mm_add_ps(brIm, flowIm), _mm_andnot_ps(quiet, _mm_mul_ps(five, load(rightInput))));
+
+            // inbound <= -reflectionFraction * bellPressure
+            const __m128 rRe = load(reflectRe);
+            const __m128 rIm = load(reflectIm);
+            float inRe[NumLanes], inIm[NumLanes], outSigRe[NumLanes], outSigIm[NumLanes];
+            store(inRe, _mm_sub_ps(_mm_mul_ps(rRe, bRe), _mm_mul_ps(rIm, bIm)));
+            store(inIm, _mm_add_ps(_mm_mul_ps(rRe, bIm), _mm_mul_ps(rIm, bRe)));
+            store(outSigRe, outRe);
+            store(outSigIm, outIm);
+            for (int lane = 0; lane < NumLanes; ++lane)
+            {
+                outbound[lane].write(complex_t{outSigRe[lane], outSigIm[lane]});
+                inbound[lane].write(complex_t{inRe[lane], inIm[lane]});
+            }
+
+            // Update the mouth pressure, or vent it completely when quiet.
+            const __m128 mouthDenom = _mm_mul_ps(_mm_set1_ps(mouthVolume), rate);
+            mpRe = _mm_andnot_ps(quiet, _mm_add_ps(mpRe, _mm_div_ps(_mm_sub_ps(load(airflow), flowRe), mouthDenom)));
+            mpIm = _mm_andnot_ps(quiet, _mm_sub_ps(mpIm, _mm_div_ps(flowIm, mouthDenom)));
+            store(mouthPressureRe, mpRe);
+            store(mouthPressureIm, mpIm);
+
+            // F = ma for the piston.
+            const __m128 k = load(springConstant);
+            const __m128 area = _mm_set1_ps(pistonArea);
+            const __m128 massRate = _mm_mul_ps(_mm_set1_ps(pistonMass), rate);
+            __m128 dvRe = _mm_div_ps(_mm_sub_ps(_mm_mul_ps(_mm_sub_ps(mpRe, brRe), area), _mm_mul_ps(_mm_sub_ps(posRe, _mm_set1_ps(springRestLength)), k)), massRate);
+            __m128 dvIm = _mm_div_ps(_mm_sub_ps(_mm_mul_ps(_mm_sub_ps(mpIm, brIm), area), _mm_mul_ps(posIm, k)), massRate);
+
+            // Vortex: dv *= (1-x) + x*(dv/|dv|), wherever |dv| > 0.
+            const __m128 dvmag = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dvRe, dvRe), _mm_mul_ps(dvIm, dvIm)));
+            const __m128 moving = _mm_cmpgt_ps(dvmag, zero);
+            const __m128 safeMag = select(moving, dvmag, one);
+            const __m128 x = _mm_mul_ps(load(vortex), _mm_set1_ps(0.5f));
+            const __m128 fRe = _mm_add_ps(_mm_sub_ps(one, x), _mm_mul_ps(x, _mm_div_ps(dvRe, safeMag)));
+            const __m128 fIm = _mm_mul_ps(x, _mm_div_ps(dvIm, safeMag));
+            const __m128 swirlRe = _mm_sub_ps(_mm_mul_ps(dvRe, fRe), _mm_mul_ps(dvIm, fIm));
+            const __m128 swirlIm = _mm_add_ps(_mm_mul_ps(dvRe, fIm), _mm_mul_ps(dvIm, fRe));
+            dvRe = select(moving, swirlRe, dvRe);
+            dvIm = select(moving, swirlIm, dvIm);
+
+            // dx = v*dt, using the mean speed over the interval.
+            const __m128 half = _mm_set1_ps(0.5f);
+            __m128 spRe = load(pistonSpeedRe);
+            __m128 spIm = load(pistonSpeedIm);
+            __m128 newPosRe = _mm_add_ps(posRe, _mm_div_ps(_mm_add_ps(spRe, _mm_mul_ps(dvRe, half)), rate));
+            __m128 newPosIm = _mm_add_ps(posIm, _mm_div_ps(_mm_add_ps(spIm, _mm_mul_ps(dvIm, half)), rate));
+
+            // If the piston hits a stopper, halt its speed also.
+            const __m128 s1 = load(stopper1);
+            const __m128 s2 = load(stopper2);
+            const __m128 below = _mm_cmplt_ps(newPosRe, s1);
+            const __m128 above = _mm_andnot_ps(below, _mm_cmpgt_ps(newPosRe, s2));
+            const __m128 stopped = _mm_or_ps(below, above);
+            newPosRe = select(below, s1, select(above, s2, newPosRe));
+            newPosIm = _mm_andnot_ps(stopped, newPosIm);
+            spRe = _mm_andnot_ps(stopped, _mm_add_ps(spRe, dvRe));
+            spIm = _mm_andnot_ps(stopped, _mm_add_ps(spIm, dvIm));
+            store(pistonPositionRe, newPosRe);
+            store(pistonPositionIm, newPosIm);
+            store(pistonSpeedRe, spRe);
+            store(pistonSpeedIm, spIm);
+
+            // Low pass filter at 8 kHz, applied to bellPressure * (1+i).
+            filterUpdate(
+                _mm_set1_ps(static_cast<float>(sampleRate / (M_PI * 8000.0f))),
+                _mm_sub_ps(bRe, bIm),
+                _mm_add_ps(bRe, bIm),
+                loPassXRe, loPassXIm, loPassYRe, loPassYIm
+            );
+
+            const __m128 g = _mm_set1_ps(gain);
+            const float km = Cube(1-mix);
+            const __m128 dryMix = _mm_set1_ps(km);
+            const __m128 wetMix = _mm_set1_ps(1-km);
+            store(leftOutput,  _mm_add_ps(_mm_mul_ps(dryMix, load(leftInput)),  _mm_mul_ps(wetMix, _mm_mul_ps(load(loPassYRe), g))));
+            store(rightOutput, _mm_add_ps(_mm_mul_ps(dryMix, load(rightInput)), _mm_mul_ps(wetMix, _mm_mul_ps(load(loPassYIm), g))));
+
+            if (enableAgc)
+            {
+                // Automatic gain control to limit excessive output voltages.
+                for (int lane = 0; lane < NumLanes; ++lane)
+                    agc[lane].process(sampleRate, leftOutput[lane], rightOutput[lane]);
+            }
+        }
+    };
 }
@@ -77,7 +77,9 @@ namespace Sapphire
 
         struct TubeUnitModule : SapphireModule
         {
-            TubeUnitEngine engine[PORT_MAX_CHANNELS];
+            static const int NumLanes = TubeUnitSimdEngine::NumLanes;
+            static const int NumEngines = (PORT_MAX_CHANNELS + NumLanes - 1) / NumLanes;
+            TubeUnitSimdEngine engine[NumEngines];      // each engine runs 4 channels in lockstep
             bool isInvertedVentPort = false;
             int numActiveChannels = 0;
             const int outputVerifyInterval = 11000;
@@ -122,8 +124,8 @@ namespace Sapphire
                 isInvertedVentPort = false;
                 outputVerifyCounter = 0;
 
-                for (int c = 0; c < PORT_MAX_CHANNELS; ++c)
-                    engine[c].initialize();
+                for (TubeUnitSimdEngine& e : engine)
+                    e.initialize();
             }
 
             void onReset(const ResetEvent& e) override
@@ -150,8 +152,8 @@ namespace Sapphire
 
             void onSampleRateChange(const SampleRateChangeEvent& e) override
             {
-                for (int c = 0; c < PORT_MAX_CHANNELS; ++c)
-                    engine[c].setSampleRate(e.sampleRate);
+                for (TubeUnitSimdEngine& eng : engine)
+                    eng.setSampleRate(e.sampleRate);
             }
 
             void onBypass(const BypassEvent&) override
@@ -194,14 +196,19 @@ namespace Sapphire
                     else if (qv < 0.1f)
                         quiet = isInvertedVentPort;
                     else
-                        quiet = engine[c].getQuiet();
+                        quiet = getQuiet(c);
                 }
                 else if (quietGateChannels > 0)
-                    quiet = engine[quietGateChannels-1].getQuiet();
+                    quiet = getQuiet(quietGateChannels-1);
                 else
                     quiet = isInvertedVentPort;
 
-                engine[c].setQuiet(quiet);
+                engine[c / NumLanes].setQuiet(c % NumLanes, quiet);
+            }
+
+            bool getQuiet(int c) const
+            {
+                return engine[c / NumLanes].getQuiet(c % NumLanes);
             }
 
             void process(const ProcessArgs& args) override
@@ -226,18 +233,22 @@ namespace Sapphire
                     timeForOutputCheck = true;
                 }
 
+                float leftInput[NumEngines * NumLanes]{};
+                float rightInput[NumEngines * NumLanes]{};
                 for (int c = 0; c < numActiveChannels; ++c)
                 {
+                    TubeUnitSimdEngine& e = engine[c / NumLanes];
+                    const int lane = c % NumLanes;
                     updateQuiet(c);
-                    engine[c].setGain(params.at(LEVEL_KNOB_PARAM).getValue());
-                    engine[c].setAirflow(getControlValue(AIRFLOW_INPUT, c));
-                    engine[c].setRootFrequency(4 * TwoToPower(getControlValue(ROOT_FREQUENCY_INPUT, c)));
-                    engine[c].setReflectionDecay(getControlValue(REFLECTION_DECAY_INPUT, c));
-                    engine[c].setReflectionAngle(M_PI * getControlValue(REFLECTION_ANGLE_INPUT, c));
-                    engine[c].setSpringConstant(0.005f * TenToPower(4.0f * getControlValue(STIFFNESS_INPUT, c)));
-                    engine[c].setBypassWidth(getControlValue(BYPASS_WIDTH_INPUT, c));
-                    engine[c].setBypassCenter(getControlValue(BYPASS_CENTER_INPUT, c));
-                    engine[c].setVortex(getControlValue(VORTEX_INPUT, c));
+                    e.setGain(params.at(LEVEL_KNOB_PARAM).getValue());
+                    e.setAirflow(lane, getControlValue(AIRFLOW_INPUT, c));
+                    e.setRootFrequency(lane, 4 * TwoToPower(getControlValue(ROOT_FREQUENCY_INPUT, c)));
+                    e.setReflectionDecay(lane, getControlValue(REFLECTION_DECAY_INPUT, c));
+                    e.setReflectionAngle(lane, M_PI * getControlValue(REFLECTION_ANGLE_INPUT, c));
+                    e.setSpringConstant(lane, 0.005f * TenToPower(4.0f * getControlValue(STIFFNESS_INPUT, c)));
+                    e.setBypassWidth(lane, getControlValue(BYPASS_WIDTH_INPUT, c));
+                    e.setBypassCenter(lane, getControlValue(BYPASS_CENTER_INPUT, c));
+                    e.setVortex(lane, getControlValue(VORTEX_INPUT, c));
 
                     if (c < inputs.at(AUDIO_LEFT_INPUT).getChannels())
                         leftIn = inputs.at(AUDIO_LEFT_INPUT).getVoltage(c) / 5.0f;
@@ -245,8 +256,24 @@ namespace Sapphire
                     if (c < inputs.at(AUDIO_RIGHT_INPUT).getChannels())
                         rightIn = inputs.at(AUDIO_RIGHT_INPUT).getVoltage(c) / 5.0f;
 
-                    float leftOut, rightOut;
-                    engine[c].process(leftOut, rightOut, leftIn, rightIn);
+                    leftInput[c] = leftIn;
+                    rightInput[c] = rightIn;
+                }
+
+                // Run all active channels, 4 at a time.
+                float leftOutput[NumEngines * NumLanes];
+                float rightOutput[NumEngines * NumLanes];
+                const int numActiveEngines = (numActiveChannels + NumLanes - 1) / NumLanes;
+                for (int i = 0; i < numActiveEngines; ++i)
+                {
+                    const int c = i * NumLanes;
+                    engine[i].process(&leftOutput[c], &rightOutput[c], &leftInput[c], &rightInput[c]);
+                }
+
+                for (int c = 0; c < numActiveChannels; ++c)
+                {
+                    float leftOut = leftOutput[c];
+                    float rightOut = rightOutput[c];
 
                     if (timeForOutputCheck)
                     {
@@ -261,8 +288,8 @@ namespace Sapphire
                             // Turn on the bright pink panic light on the OUTPUT level knob for 1 second.
                             limiterRecoveryCountdown = static_cast<int>(args.sampleRate);
 
-                            // Reset this engine, which hopefully fixes its output issues.
-                            engine[c].initialize();
+                            // Reset this channel, which hopefully fixes its output issues.
+                            engine[c / NumLanes].initialize(c % NumLanes);
                         }
                     }
 
@@ -281,11 +308,11 @@ namespace Sapphire
                 if (agcLevelQuantity && agcLevelQuantity->changed)
                 {
                     bool enabled = agcLevelQuantity->isAgcEnabled();
-                    for (int c = 0; c < PORT_MAX_CHANNELS; ++c)
+                    for (TubeUnitSimdEngine& e : engine)
                     {
                         if (enabled)
-                            engine[c].setAgcLevel(agcLevelQuantity->clampedAgc() / 5.0f);
-                        engine[c].setAgcEnabled(enabled);
+                            e.setAgcLevel(agcLevelQuantity->clampedAgc() / 5.0f);
+                        e.setAgcEnabled(enabled);
                     }
                     agcLevelQuantity->changed = false;
                 }
@@ -296,7 +323,7 @@ namespace Sapphire
                 // Return the maximum distortion from the engines that are actively producing output.
                 double distortion = 0;
                 for (int c = 0; c < numActiveChannels; ++c)
-                    distortion = std::max(distortion, engine[c].getAgcDistortion());
+                    distortion = std::max(distortion, engine[c / NumLanes].getAgcDistortion(c % NumLanes));
                 return distortion;
             }
 
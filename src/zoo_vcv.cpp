@@ -231,6 +231,7 @@ namespace Sapphire
                     circuit.resetProgram();
             }
 
+            circuit.publishProgram();
             shouldClearTricorder = true;
         }
 
@@ -328,7 +329,7 @@ namespace Sapphire
             if (++spamCount < spamLimit)
                 WARN("EXCEPTION %d/%d : function %s received exception [%s]", spamCount, spamLimit, func, what);
 
-            circuit.resetProgram();
+            circuit.haltProgram();     // log() runs on the audio thread, which must not touch the program being edited
             resetAttractor();
         }
     };
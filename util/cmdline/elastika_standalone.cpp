@@ -4,11 +4,27 @@
     Demo of using the Elastika engine completely outside of VCV Rack.
 */
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include "elastika_engine.hpp"
 #include "wavefile.hpp"
 
+static void ConfigureEngine(Sapphire::ElastikaEngine& engine)
+{
+    engine.setAgcEnabled(false);
+    engine.setDcRejectFrequency(80.0);
+    engine.setFriction(0.25379982590675354);
+    engine.setStiffness(0.64640343189239502);
+    engine.setSpan(0.5331994891166687);
+    engine.setCurl(0.37039878964424133);
+    engine.setMass(-0.62280040979385376);
+    engine.setDrive(1.0);
+    engine.setGain(1.06);
+    engine.setInputTilt(0.5);
+    engine.setOutputTilt(0.5);
+}
+
 int main()
 {
     using namespace std;
@@ -22,17 +38,9 @@ int main()
     const int FADE_SAMPLES = SAMPLE_RATE * FADE_SECONDS;
 
     ElastikaEngine engine;
-    engine.setAgcEnabled(false);
-    engine.setDcRejectFrequency(80.0);
-    engine.setFriction(0.25379982590675354);
-    engine.setStiffness(0.64640343189239502);
-    engine.setSpan(0.5331994891166687);
-    engine.setCurl(0.37039878964424133);
-    engine.setMass(-0.62280040979385376);
-    engine.setDrive(1.0);
-    engine.setGain(1.06);
-    engine.setInputTilt(0.5);
-    engine.setOutputTilt(0.5);
+    ElastikaEngine blockEngine;
+    ConfigureEngine(engine);
+    ConfigureEngine(blockEngine);
 
     WaveFileWriter wave;
     const char *filename = "test/elastika.wav";
@@ -42,16 +50,39 @@ int main()
         return 1;
     }
 
+    // Render the same audio through both the per-sample and the block-based
+    // processing paths. They must produce bit-identical output.
+    const int BLOCK_SIZE = 256;
     float sample[CHANNELS];
-
-    for (int s = 0; s < DURATION_SAMPLES; ++s)
+    float silence[BLOCK_SIZE] {};
+    float blockLeft[BLOCK_SIZE];
+    float blockRight[BLOCK_SIZE];
+    int s = 0;
+    while (s < DURATION_SAMPLES)
     {
-        engine.process(SAMPLE_RATE, 0.0f, 0.0f, sample[0], sample[1]);
-        wave.WriteSamples(sample, CHANNELS);
-        if (s == FADE_SAMPLES)
+        // Split blocks so the parameter change happens at the same frame in both paths.
+        int nframes = std::min(BLOCK_SIZE, DURATION_SAMPLES - s);
+        if (s <= FADE_SAMPLES)
+            nframes = std::min(nframes, (FADE_SAMPLES + 1) - s);
+
+        blockEngine.processBlock(SAMPLE_RATE, silence, silence, blockLeft, blockRight, nframes);
+
+        for (int i = 0; i < nframes; ++i, ++s)
         {
-            engine.setFriction(0.46f);
-            engine.setCurl(0.0f);
+            engine.process(SAMPLE_RATE, 0.0f, 0.0f, sample[0], sample[1]);
+            if (sample[0] != blockLeft[i] || sample[1] != blockRight[i])
+            {
+                fprintf(stderr, "ERROR: Block output does not match per-sample output at frame %d\n", s);
+                return 1;
+            }
+            wave.WriteSamples(sample, CHANNELS);
+            if (s == FADE_SAMPLES)
+            {
+                engine.setFriction(0.46f);
+                engine.setCurl(0.0f);
+                blockEngine.setFriction(0.46f);
+                blockEngine.setCurl(0.0f);
+            }
         }
     }
 
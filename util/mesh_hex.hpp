@@ -3,19 +3,6 @@
 
 namespace Sapphire
 {
-    struct Spring
-    {
-        int ballIndex1;         // 0-based index into Mesh::ballList
-        int ballIndex2;         // 0-based index into Mesh::ballList
-
-        Spring(int _ballIndex1, int _ballIndex2)
-            : ballIndex1(_ballIndex1)
-            , ballIndex2(_ballIndex2)
-            {}
-    };
-
-    using SpringList = std::vector<Spring>;
-
     class PhysicsMeshGen : public PhysicsMesh   // Includes explicit springs. Used by code generator only.
     {
     protected:
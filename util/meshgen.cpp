@@ -4,19 +4,34 @@
     https://github.com/cosinekitty/sapphire
 */
 #include <cstdio>
+#include <cstdlib>
 #include "file_updater.hpp"
 #include "mesh_hex.hpp"
+#include "mesh_runtime.hpp"
 
-static int WritePrefix(FILE *outfile);
+static int WritePrefix(FILE *outfile, const char *headerFileName);
 static int GenAudioParameters(FILE *outfile, const char *className, const Sapphire::MeshAudioParameters& mp);
 static int GenConstructor(FILE *outfile, const char *className, const Sapphire::PhysicsMeshGen& mesh, int nmobile);
 static int GenDampenFunction(FILE *outfile, const char *className, const Sapphire::PhysicsMeshGen& mesh, int nmobile);
 static int GenForceFunction(FILE *outfile, const char *className, const Sapphire::PhysicsMeshGen& mesh);
+static int GenBatchForceFunction(FILE *outfile, const char *className, const Sapphire::PhysicsMeshGen& mesh, int nmobile);
 static int GenExtrapolateFunction(FILE *outfile, const char *className, const Sapphire::PhysicsMeshGen& mesh, int nmobile);
+static int GenSimdConstructor(FILE *outfile, const char *className, const Sapphire::PhysicsMeshGen& mesh, int nmobile);
 static int WriteSuffix(FILE *outfile);
+static int ExportMeshFile(const char *outFileName, const Sapphire::PhysicsMeshGen& mesh, const Sapphire::MeshAudioParameters& mp);
+
+enum class MeshCodeKind
+{
+    Unrolled,       // scalar code with every spring unrolled, derived from PhysicsMesh
+    Batched,        // like Unrolled, but evaluates springs 4 at a time with CalcSpringForces
+    Simd,           // SimdMesh topology tables for PolySimdMesh
+};
+
 
 static int GenerateMeshCode(
+    MeshCodeKind kind,
     const char *outFileName,
+    const char *headerFileName,
     const char *className,
     const Sapphire::PhysicsMeshGen& mesh,
     const Sapphire::MeshAudioParameters& mp)
@@ -46,15 +61,30 @@ static int GenerateMeshCode(
         return 1;
     }
 
-    int rc =
-        WritePrefix(outfile) ||
-        GenConstructor(outfile, className, mesh, nmobile) ||
-        GenDampenFunction(outfile, className, mesh, nmobile) ||
-        GenForceFunction(outfile, className, mesh) ||
-        GenExtrapolateFunction(outfile, className, mesh, nmobile) ||
-        GenAudioParameters(outfile, className, mp) ||
-        WriteSuffix(outfile)
-    ;
+    int rc;
+    if (kind == MeshCodeKind::Simd)
+    {
+        rc =
+            WritePrefix(outfile, headerFileName) ||
+            GenSimdConstructor(outfile, className, mesh, nmobile) ||
+            GenAudioParameters(outfile, className, mp) ||
+            WriteSuffix(outfile)
+        ;
+    }
+    else
+    {
+        rc =
+            WritePrefix(outfile, headerFileName) ||
+            GenConstructor(outfile, className, mesh, nmobile) ||
+            GenDampenFunction(outfile, className, mesh, nmobile) ||
+            ((kind == MeshCodeKind::Batched) ?
+                GenBatchForceFunction(outfile, className, mesh, nmobile) :
+                GenForceFunction(outfile, className, mesh)) ||
+            GenExtrapolateFunction(outfile, className, mesh, nmobile) ||
+            GenAudioParameters(outfile, className, mp) ||
+            WriteSuffix(outfile)
+        ;
+    }
 
     fclose(outfile);
 
@@ -73,14 +103,71 @@ int main()
     using namespace Sapphire;
     PhysicsMeshGen mesh;
     MeshAudioParameters mp = CreateHex(mesh);
-    return GenerateMeshCode("../src/elastika_mesh.cpp", "ElastikaMesh", mesh, mp);
+    return
+        GenerateMeshCode(MeshCodeKind::Unrolled, "../src/elastika_mesh.cpp", "elastika_mesh.hpp", "ElastikaMesh", mesh, mp) ||
+        GenerateMeshCode(MeshCodeKind::Batched, "../src/elastika_batch_mesh.cpp", "elastika_batch_mesh.hpp", "ElastikaBatchMesh", mesh, mp) ||
+        GenerateMeshCode(MeshCodeKind::Simd, "../src/elastika_simd_mesh.cpp", "elastika_simd_mesh.hpp", "ElastikaSimdMesh", mesh, mp) ||
+        ExportMeshFile("unittest/input/elastika.smsh", mesh, mp);
 }
 
 
-static int WritePrefix(FILE *outfile)
+static int ExportMeshFile(
+    const char *outFileName,
+    const Sapphire::PhysicsMeshGen& mesh,
+    const Sapphire::MeshAudioParameters& mp)
+{
+    using namespace Sapphire;
+
+    // Round the values exactly the way GenConstructor and GenAudioParmVector print them,
+    // so the exported mesh matches the generated code bit for bit.
+    auto rounded = [](float x, const char *format) -> float
+    {
+        char text[40];
+        snprintf(text, sizeof(text), format, x);
+        return static_cast<float>(strtod(text, nullptr));
+    };
+
+    auto roundedVector = [&](const PhysicsVector& v) -> PhysicsVector
+    {
+        return PhysicsVector(rounded(v[0], "%0.6g"), rounded(v[1], "%0.6g"), rounded(v[2], "%0.6g"), 0);
+    };
+
+    MeshDescription desc;
+    for (int i = 0; i < mesh.NumBalls(); ++i)
+    {
+        const Ball& b = mesh.GetBallAt(i);
+        desc.balls.push_back(Ball(rounded(b.mass, "%0.7g"), rounded(b.pos[0], "%0.7g"), rounded(b.pos[1], "%0.7g"), rounded(b.pos[2], "%0.7g")));
+    }
+    desc.springs = mesh.GetSprings();
+    desc.audio = mp;
+    desc.audio.leftInputDir1   = roundedVector(mp.leftInputDir1);
+    desc.audio.leftInputDir2   = roundedVector(mp.leftInputDir2);
+    desc.audio.rightInputDir1  = roundedVector(mp.rightInputDir1);
+    desc.audio.rightInputDir2  = roundedVector(mp.rightInputDir2);
+    desc.audio.leftOutputDir1  = roundedVector(mp.leftOutputDir1);
+    desc.audio.leftOutputDir2  = roundedVector(mp.leftOutputDir2);
+    desc.audio.rightOutputDir1 = roundedVector(mp.rightOutputDir1);
+    desc.audio.rightOutputDir2 = roundedVector(mp.rightOutputDir2);
+
+    try
+    {
+        WriteMeshFile(outFileName, desc);
+    }
+    catch (const std::exception& ex)
+    {
+        printf("ExportMeshFile(FATAL): %s\n", ex.what());
+        return 1;
+    }
+
+    printf("ExportMeshFile: wrote %s\n", outFileName);
+    return 0;
+}
+
+
+static int WritePrefix(FILE *outfile, const char *headerFileName)
 {
     fprintf(outfile, "//****  GENERATED CODE  ****  DO NOT EDIT  *****\n\n");
-    fprintf(outfile, "#include \"elastika_mesh.hpp\"\n\n");
+    fprintf(outfile, "#include \"%s\"\n\n", headerFileName);
     fprintf(outfile, "namespace Sapphire\n");
     fprintf(outfile, "{\n");
     return 0;
@@ -149,6 +236,41 @@ static int GenConstructor(FILE *outfile, const char *className, const Sapphire::
 }
 
 
+static int GenSimdConstructor(FILE *outfile, const char *className, const Sapphire::PhysicsMeshGen& mesh, int nmobile)
+{
+    using namespace Sapphire;
+
+    const int nballs = mesh.NumBalls();
+
+    fprintf(outfile, "    %s::%s()\n", className, className);
+    fprintf(outfile, "        : SimdMesh(%d, %d)\n", nballs, nmobile);
+    fprintf(outfile, "    {\n");
+
+    for (int i = 0; i < nballs; ++i)
+    {
+        const Ball& b = mesh.GetBallAt(i);
+        fprintf(outfile, "        AddBall(%7.7g, %7.7g, %14.7g, %0.7g);   // %2d\n", b.mass, b.pos[0], b.pos[1], b.pos[2], i);
+    }
+
+    fprintf(outfile, "\n");
+
+    // Emit springs in the same order as the unrolled code, so that forces accumulate similarly.
+    for (const Spring& s : mesh.GetSprings())
+    {
+        if (mesh.GetBallAt(s.ballIndex1).IsAnchor() && mesh.GetBallAt(s.ballIndex2).IsAnchor())
+        {
+            printf("GenSimdConstructor(FATAL): both balls are anchors: %d, %d\n", s.ballIndex1, s.ballIndex2);
+            return 1;
+        }
+        fprintf(outfile, "        AddSpring(%2d, %2d);\n", s.ballIndex1, s.ballIndex2);
+    }
+
+    fprintf(outfile, "    }\n");
+    fprintf(outfile, "\n");
+    return 0;
+}
+
+
 static void EmitCrossProduct(
     FILE *outfile,
     const Sapphire::PhysicsMeshGen& mesh,
@@ -236,12 +358,61 @@ static int GenForceFunction(FILE *outfile, const char *className, const Sapphire
 }
 
 
+static int GenBatchForceFunction(FILE *outfile, const char *className, const Sapphire::PhysicsMeshGen& mesh, int nmobile)
+{
+    using namespace Sapphire;
+
+    fprintf(outfile, "    void %s::CalcForces(const BallList& blist)\n", className);
+    fprintf(outfile, "    {\n");
+
+    for (int i = 0; i < nmobile; ++i)
+        fprintf(outfile, "        forceList[%d] = Cross(blist[%d].vel, magnet);\n", i, i);
+
+    // Springs are batched in the same order as the unrolled code,
+    // so every ball's forces are added in the same order.
+    const SpringList& slist = mesh.GetSprings();
+    const int nsprings = static_cast<int>(slist.size());
+    for (int first = 0; first < nsprings; first += 4)
+    {
+        fprintf(outfile, "\n");
+        fprintf(outfile, "        %s = CalcSpringForces(stiffness, restLength", (first == 0) ? "SpringForceBatch batch" : "batch");
+        for (int k = first; k < first + 4; ++k)
+        {
+            if (k < nsprings)
+                fprintf(outfile, ",\n            blist[%2d].pos - blist[%2d].pos", slist[k].ballIndex2, slist[k].ballIndex1);
+            else
+                fprintf(outfile, ",\n            PhysicsVector::zero()");
+        }
+        fprintf(outfile, ");\n");
+
+        for (int k = first; k < first + 4 && k < nsprings; ++k)
+        {
+            const Spring& s = slist[k];
+            const bool mobile1 = mesh.GetBallAt(s.ballIndex1).IsMobile();
+            const bool mobile2 = mesh.GetBallAt(s.ballIndex2).IsMobile();
+            if (!mobile1 && !mobile2)
+            {
+                printf("GenBatchForceFunction(FATAL): both balls are anchors: %d, %d\n", s.ballIndex1, s.ballIndex2);
+                return 1;
+            }
+            if (mobile1)
+                fprintf(outfile, "        forceList[%2d] += batch.force[%d];\n", s.ballIndex1, k - first);
+            if (mobile2)
+                fprintf(outfile, "        forceList[%2d] -= batch.force[%d];\n", s.ballIndex2, k - first);
+        }
+    }
+
+    fprintf(outfile, "    }\n");
+    fprintf(outfile, "\n");
+    return 0;
+}
+
+
 static int GenDampenFunction(FILE *outfile, const char *className, const Sapphire::PhysicsMeshGen& mesh, int nmobile)
 {
     // Unroll the dampen loop.
-    fprintf(outfile, "    void %s::Dampen(float dt, float halflife)\n", className);
+    fprintf(outfile, "    void %s::Dampen(float damp)\n", className);
     fprintf(outfile, "    {\n");
-    fprintf(outfile, "        const float damp = OneHalfToPower(dt/halflife);\n");
     for (int i = 0; i < nmobile; ++i)
         fprintf(outfile, "        currBallList[%2d].vel *= damp;\n", i);
     fprintf(outfile, "    }\n\n");